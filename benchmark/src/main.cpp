@@ -0,0 +1,529 @@
+#include "ofMain.h"
+#include "ofxSunCalc.h"
+#include "ofxSunCalcChebyshev.h"
+#include "ofxSunCalcDayInfoCache.h"
+#include "ofxSunCalcScheduler.h"
+#include "ofxSunCalcTileCache.h"
+
+#include <atomic>
+#include <new>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+/*
+    ofxSunCalc Benchmarks
+
+    Google Benchmark suite over the public ofxSunCalc entry points, reports ns/op and
+    allocs/op (heap allocations per call, counted by the operator new overrides below).
+
+    Needs google benchmark installed (libbenchmark-dev / brew install google-benchmark),
+    build with `make Release` and run `./bin/benchmark` (any --benchmark_* flags apply).
+
+    Latitude sweeps use arg / 10 degrees and include both polar regions.
+ */
+
+//========================================================================
+// allocation counting
+
+static std::atomic<size_t> allocation_count(0);
+
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete" // free() of our own malloc() backed new
+#endif
+
+void * operator new(size_t size) {
+    allocation_count.fetch_add(1, std::memory_order_relaxed);
+    if(void * p = malloc(size == 0 ? 1 : size)) return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void * p) noexcept {
+    free(p);
+}
+
+void operator delete(void * p, size_t) noexcept {
+    free(p);
+}
+
+class AllocationCounter {
+public:
+    AllocationCounter(benchmark::State & state) : state(state), start(allocation_count.load()) {}
+    ~AllocationCounter() {
+        state.counters["allocs/op"] = benchmark::Counter((double)(allocation_count.load() - start), benchmark::Counter::kAvgIterations);
+    }
+private:
+    benchmark::State & state;
+    size_t start;
+};
+
+//========================================================================
+// fixtures
+
+static const Poco::DateTime bench_date(2015, 6, 21, 10, 30, 0);
+
+static void latitudeSweep(benchmark::internal::Benchmark * b) {
+    for(int lat : { -899, -700, -338, 0, 450, 600, 700, 899 }) {
+        b->Arg(lat);
+    }
+}
+
+static void latitudeDetailSweep(benchmark::internal::Benchmark * b) {
+    for(int lat : { -899, -700, -338, 0, 450, 600, 700, 899 }) {
+        b->Args({ lat, 0 });
+        b->Args({ lat, 1 });
+    }
+}
+
+static double argLat(benchmark::State & state) {
+    return state.range(0) / 10.0;
+}
+
+static const double bench_lon = 151.2117;
+
+//========================================================================
+// positions
+
+static void BM_getSunPosition_date(benchmark::State & state) {
+    ofxSunCalc sun_calc;
+    double lat = argLat(state);
+    AllocationCounter allocs(state);
+    for(auto _ : state) {
+        benchmark::DoNotOptimize(sun_calc.getSunPosition(bench_date, lat, bench_lon));
+    }
+}
+BENCHMARK(BM_getSunPosition_date)->Apply(latitudeSweep);
+
+static void BM_getSunPosition_julian(benchmark::State & state) {
+    ofxSunCalc sun_calc;
+    double J = sun_calc.dateToJulianDate(bench_date);
+    double phi = argLat(state) * DEG_TO_RAD;
+    double lw = -bench_lon * DEG_TO_RAD;
+    AllocationCounter allocs(state);
+    for(auto _ : state) {
+        benchmark::DoNotOptimize(sun_calc.getSunPosition(J, lw, phi));
+    }
+}
+BENCHMARK(BM_getSunPosition_julian)->Apply(latitudeSweep);
+
+static void BM_getMoonPosition(benchmark::State & state) {
+    ofxSunCalc sun_calc;
+    double lat = argLat(state);
+    AllocationCounter allocs(state);
+    for(auto _ : state) {
+        benchmark::DoNotOptimize(sun_calc.getMoonPosition(bench_date, lat, bench_lon));
+    }
+}
+BENCHMARK(BM_getMoonPosition)->Apply(latitudeSweep);
+
+// range(0) = SunCalcAccuracy tier
+template<bool moon>
+static void BM_getPositionAccuracy(benchmark::State & state) {
+    ofxSunCalc sun_calc;
+    SunCalcAccuracy accuracy = (SunCalcAccuracy)state.range(0);
+    AllocationCounter allocs(state);
+    for(auto _ : state) {
+        if(moon) benchmark::DoNotOptimize(sun_calc.getMoonPosition(bench_date, -33.8647, bench_lon, accuracy));
+        else benchmark::DoNotOptimize(sun_calc.getSunPosition(bench_date, -33.8647, bench_lon, accuracy));
+    }
+}
+BENCHMARK_TEMPLATE(BM_getPositionAccuracy, false)->DenseRange(SUNCALC_ACCURACY_FAST, SUNCALC_ACCURACY_HIGH);
+BENCHMARK_TEMPLATE(BM_getPositionAccuracy, true)->DenseRange(SUNCALC_ACCURACY_FAST, SUNCALC_ACCURACY_HIGH);
+
+// simulation stepping one site a minute at a time over a year, range(0) = 0 direct model,
+// 1 Chebyshev ephemeris
+template<bool moon>
+static void BM_chebyshevPosition(benchmark::State & state) {
+    ofxSunCalc sun_calc;
+    double J0 = sun_calc.dateToJulianDate(bench_date);
+    ofxSunCalcChebyshev ephemeris;
+    if(state.range(0)) ephemeris.build(J0, J0 + 366);
+    double phi = -33.8647 * DEG_TO_RAD;
+    double lw = -bench_lon * DEG_TO_RAD;
+    size_t i = 0;
+    AllocationCounter allocs(state);
+    for(auto _ : state) {
+        double J = J0 + (i++ % (365 * 1440)) / 1440.0;
+        if(moon) benchmark::DoNotOptimize(ephemeris.getMoonPosition(J, lw, phi));
+        else benchmark::DoNotOptimize(ephemeris.getSunPosition(J, lw, phi));
+    }
+}
+BENCHMARK_TEMPLATE(BM_chebyshevPosition, false)->Arg(0)->Arg(1);
+BENCHMARK_TEMPLATE(BM_chebyshevPosition, true)->Arg(0)->Arg(1);
+
+// fixed sites polled at one instant, range(0) = 0 lw / phi, 1 precomputed SunCalcObserver
+static void BM_observerSunPosition(benchmark::State & state) {
+    ofxSunCalc sun_calc;
+    double J = sun_calc.dateToJulianDate(bench_date);
+    std::vector<SunCalcObserver> sites(4096);
+    for(size_t i = 0; i < sites.size(); i++) {
+        sites[i] = ofxSunCalcCore::getObserver(ofMap(i, 0, sites.size(), -89, 89), ofMap(i % 64, 0, 64, -180, 180));
+    }
+    bool observer = state.range(0);
+    size_t i = 0;
+    AllocationCounter allocs(state);
+    for(auto _ : state) {
+        const SunCalcObserver & o = sites[i++ & 4095];
+        if(observer) benchmark::DoNotOptimize(ofxSunCalcCore::getSunPosition(J, o));
+        else benchmark::DoNotOptimize(ofxSunCalcCore::getSunPosition(J, -o.lon * DEG_TO_RAD, o.lat * DEG_TO_RAD));
+    }
+}
+BENCHMARK(BM_observerSunPosition)->Arg(0)->Arg(1);
+
+// per position cost of the batch paths, range(0) = sites per call
+template<bool fast>
+static void BM_getSunPositions(benchmark::State & state) {
+    ofxSunCalc sun_calc;
+    size_t count = state.range(0);
+    double J = sun_calc.dateToJulianDate(bench_date);
+    std::vector<double> lw(count), phi(count), az(count), alt(count);
+    for(size_t i = 0; i < count; i++) {
+        lw[i] = ofMap(i, 0, count, -PI, PI);
+        phi[i] = ofMap(i, 0, count, -HALF_PI, HALF_PI);
+    }
+    AllocationCounter allocs(state);
+    for(auto _ : state) {
+        if(fast) sun_calc.getSunPositionsFast(J, lw.data(), phi.data(), count, az.data(), alt.data());
+        else sun_calc.getSunPositions(J, lw.data(), phi.data(), count, az.data(), alt.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK_TEMPLATE(BM_getSunPositions, false)->Arg(1024)->Arg(1 << 16);
+BENCHMARK_TEMPLATE(BM_getSunPositions, true)->Arg(1024)->Arg(1 << 16);
+
+// float precision batch, per position cost
+static void BM_getSunPositionsFloat(benchmark::State & state) {
+    ofxSunCalc sun_calc;
+    size_t count = state.range(0);
+    double J = sun_calc.dateToJulianDate(bench_date);
+    std::vector<float> lw(count), phi(count), az(count), alt(count);
+    for(size_t i = 0; i < count; i++) {
+        lw[i] = ofMap(i, 0, count, -PI, PI);
+        phi[i] = ofMap(i, 0, count, -HALF_PI, HALF_PI);
+    }
+    AllocationCounter allocs(state);
+    for(auto _ : state) {
+        ofxSunCalcCore::getSunPositionsT<float>(J, lw.data(), phi.data(), count, az.data(), alt.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK(BM_getSunPositionsFloat)->Arg(1024)->Arg(1 << 16);
+
+// per sample cost of a day at range(0) second steps
+static void BM_sweepSunPositions(benchmark::State & state) {
+    ofxSunCalc sun_calc;
+    double step = state.range(0);
+    size_t count = (size_t)(86400 / step);
+    SunCalcSite site = { -33.8647, bench_lon };
+    double J = sun_calc.dateToJulianDate(bench_date);
+    std::vector<SunCalcPosition> out(count);
+    AllocationCounter allocs(state);
+    for(auto _ : state) {
+        sun_calc.sweepSunPositions(site, J, step, count, out.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK(BM_sweepSunPositions)->Arg(1)->Arg(60);
+
+//========================================================================
+// accuracy (the max errors of the float path as counters, next to its timings; the
+// documented bounds of ofxSunCalcPrecision.h are asserted by tests/precision.cpp)
+
+template<bool moon>
+static void BM_accuracyFloat(benchmark::State & state) {
+    const double bounds[3][2] = { { 2e-6, 5e-6 }, { 5e-5, 2e-4 }, { 1e-4, 1e-3 } }; // altitude, azimuth
+    const double limits[3] = { 80, 89.9, 180 };
+    double err[3][2] = { { 0, 0 }, { 0, 0 }, { 0, 0 } };
+    size_t samples = 0;
+    
+    for(auto _ : state) {
+        for(double J = 2415020.0; J < 2488070; J += 3.137) {
+            for(double lat = -89; lat <= 89; lat += 7.7) {
+                double lon = std::remainder(J * 13.7, 360.0);
+                float lw = -lon * DEG_TO_RAD;
+                float phi = lat * DEG_TO_RAD;
+                double alt, az, altF, azF;
+                if(moon) {
+                    MoonCalcPosition p = ofxSunCalcCore::getMoonPosition(J, lw, phi);
+                    MoonCalcPositionF f = ofxSunCalcCore::getMoonPositionT<float>(J, lw, phi);
+                    alt = p.altitude; az = p.azimuth; altF = f.altitude; azF = f.azimuth;
+                }else{
+                    SunCalcPosition p = ofxSunCalcCore::getSunPosition(J, lw, phi);
+                    SunCalcPositionF f = ofxSunCalcCore::getSunPositionT<float>(J, lw, phi);
+                    alt = p.altitude; az = p.azimuth; altF = f.altitude; azF = f.azimuth;
+                }
+                double ea = fabs(altF - alt);
+                double ez = fabs(std::remainder(azF - az, 2 * PI));
+                for(int k = 0; k < 3; k++) {
+                    if(fabs(alt) * RAD_TO_DEG < limits[k]) {
+                        err[k][0] = std::max(err[k][0], ea);
+                        err[k][1] = std::max(err[k][1], ez);
+                    }
+                }
+                samples++;
+            }
+        }
+    }
+    
+    const char * names[3] = { "80", "89.9", "all" };
+    for(int k = 0; k < 3; k++) {
+        state.counters[string("alt_err<") + names[k]] = err[k][0];
+        state.counters[string("az_err<") + names[k]] = err[k][1];
+        if(err[k][0] > bounds[k][0] || err[k][1] > bounds[k][1]) {
+            state.SkipWithError("float position error above the documented bound");
+        }
+    }
+    state.SetItemsProcessed(samples);
+}
+BENCHMARK_TEMPLATE(BM_accuracyFloat, false)->Iterations(1);
+BENCHMARK_TEMPLATE(BM_accuracyFloat, true)->Iterations(1);
+
+//========================================================================
+// day info
+
+static void BM_getDayInfo(benchmark::State & state) {
+    ofxSunCalc sun_calc;
+    double lat = argLat(state);
+    bool detailed = state.range(1);
+    AllocationCounter allocs(state);
+    for(auto _ : state) {
+        benchmark::DoNotOptimize(sun_calc.getDayInfo(bench_date, lat, bench_lon, detailed));
+    }
+}
+BENCHMARK(BM_getDayInfo)->Apply(latitudeDetailSweep);
+
+static void BM_dayInfoCacheHit(benchmark::State & state) {
+    ofxSunCalcDayInfoCache cache;
+    double lat = argLat(state);
+    bool detailed = state.range(1);
+    cache.getDayInfo(bench_date, lat, bench_lon, detailed);
+    AllocationCounter allocs(state);
+    for(auto _ : state) {
+        benchmark::DoNotOptimize(cache.getDayInfo(bench_date, lat, bench_lon, detailed));
+    }
+}
+BENCHMARK(BM_dayInfoCacheHit)->Apply(latitudeDetailSweep);
+
+static void BM_getDayTimes(benchmark::State & state) {
+    ofxSunCalc sun_calc;
+    double lat = argLat(state);
+    bool detailed = state.range(1);
+    AllocationCounter allocs(state);
+    for(auto _ : state) {
+        benchmark::DoNotOptimize(sun_calc.getDayTimes(bench_date, lat, bench_lon, detailed));
+    }
+}
+BENCHMARK(BM_getDayTimes)->Apply(latitudeDetailSweep);
+
+// a single event (nautical dusk) through the lazy handle, vs BM_getDayTimes/lat/1
+static void BM_lazyDayNauticalDusk(benchmark::State & state) {
+    ofxSunCalc sun_calc;
+    double J = sun_calc.dateToJulianDate(bench_date);
+    double lw = -bench_lon * DEG_TO_RAD;
+    double phi = argLat(state) * DEG_TO_RAD;
+    AllocationCounter allocs(state);
+    for(auto _ : state) {
+        benchmark::DoNotOptimize(lw); // keep the per day work inside the loop
+        benchmark::DoNotOptimize(phi);
+        benchmark::DoNotOptimize(ofxSunCalcLazyDay(J, lw, phi).getNauticalDusk());
+    }
+}
+BENCHMARK(BM_lazyDayNauticalDusk)->Apply(latitudeSweep);
+
+// warm tile cache queries around one city, vs BM_getDayTimes
+static void BM_tileCache(benchmark::State & state) {
+    ofxSunCalc sun_calc;
+    ofxSunCalcTileCache cache(sun_calc.dateToJulianDate(bench_date), state.range(0));
+    std::vector<SunCalcSite> sites(4096);
+    for(size_t i = 0; i < sites.size(); i++) {
+        sites[i].lat = -33.8647 + ofMap(i % 64, 0, 64, -0.5, 0.5);
+        sites[i].lon = bench_lon + ofMap(i / 64, 0, 64, -0.5, 0.5);
+        cache.getDayTimes(sites[i]);
+    }
+    size_t i = 0;
+    AllocationCounter allocs(state);
+    for(auto _ : state) {
+        benchmark::DoNotOptimize(cache.getDayTimes(sites[i++ & 4095]));
+    }
+}
+BENCHMARK(BM_tileCache)->Arg(0)->Arg(1);
+
+// lighting service case, range(0) fixtures each waiting on sunrise and sunset: one scheduler
+// update per simulated minute, firing whatever fell due
+static void BM_schedulerUpdate(benchmark::State & state) {
+    ofxSunCalcScheduler::SimulatedClock clock(2457194.5);
+    ofxSunCalcScheduler scheduler(clock);
+    size_t fired = 0;
+    for(int i = 0; i < state.range(0); i++) {
+        SunCalcObserver o = ofxSunCalcCore::getObserver(ofMap(i, 0, state.range(0), -60, 60), ofMap(i % 97, 0, 97, -180, 180));
+        scheduler.subscribe(o, ofxSunCalcScheduler::EVENT_SUNRISE_START, 0, [&fired](const ofxSunCalcScheduler::Fired &) { fired++; });
+        scheduler.subscribe(o, ofxSunCalcScheduler::EVENT_SUNSET_END, 0, [&fired](const ofxSunCalcScheduler::Fired &) { fired++; });
+    }
+    AllocationCounter allocs(state);
+    for(auto _ : state) {
+        clock.advance(1.0 / 1440);
+        benchmark::DoNotOptimize(scheduler.update());
+    }
+    state.counters["fired/update"] = benchmark::Counter((double)fired, benchmark::Counter::kAvgIterations);
+}
+BENCHMARK(BM_schedulerUpdate)->Arg(1000)->Arg(50000);
+
+static void BM_getMoonDayInfo(benchmark::State & state) {
+    ofxSunCalc sun_calc;
+    double lat = argLat(state);
+    AllocationCounter allocs(state);
+    for(auto _ : state) {
+        benchmark::DoNotOptimize(sun_calc.getMoonDayInfo(bench_date, lat, bench_lon));
+    }
+}
+BENCHMARK(BM_getMoonDayInfo)->Apply(latitudeSweep);
+
+//========================================================================
+// inverse queries
+
+static void BM_getAltitudeTimes(benchmark::State & state) {
+    ofxSunCalc sun_calc;
+    double lat = argLat(state);
+    AllocationCounter allocs(state);
+    for(auto _ : state) {
+        benchmark::DoNotOptimize(sun_calc.getAltitudeTimes(bench_date, lat, bench_lon, 15 * DEG_TO_RAD));
+    }
+}
+BENCHMARK(BM_getAltitudeTimes)->Apply(latitudeSweep);
+
+static void BM_getAzimuthTimes(benchmark::State & state) {
+    ofxSunCalc sun_calc;
+    double lat = argLat(state);
+    double out[2];
+    AllocationCounter allocs(state);
+    for(auto _ : state) {
+        benchmark::DoNotOptimize(sun_calc.getAzimuthTimes(bench_date, lat, bench_lon, 45 * DEG_TO_RAD, out));
+        benchmark::ClobberMemory();
+    }
+}
+BENCHMARK(BM_getAzimuthTimes)->Apply(latitudeSweep);
+
+//========================================================================
+// formatting
+
+static void BM_infoToString(benchmark::State & state) {
+    ofxSunCalc sun_calc;
+    bool min = state.range(0);
+    SunCalcDayInfo info = sun_calc.getDayInfo(bench_date, -33.8647, bench_lon, true);
+    AllocationCounter allocs(state);
+    for(auto _ : state) {
+        benchmark::DoNotOptimize(sun_calc.infoToString(info, min));
+    }
+}
+BENCHMARK(BM_infoToString)->Arg(1)->Arg(0);
+
+// reuses one string, allocs/op should be 0
+static void BM_infoToString_reuse(benchmark::State & state) {
+    ofxSunCalc sun_calc;
+    bool min = state.range(0);
+    SunCalcDayInfo info = sun_calc.getDayInfo(bench_date, -33.8647, bench_lon, true);
+    string out;
+    sun_calc.infoToString(info, out, min);
+    AllocationCounter allocs(state);
+    for(auto _ : state) {
+        sun_calc.infoToString(info, out, min);
+        benchmark::DoNotOptimize(out.data());
+    }
+}
+BENCHMARK(BM_infoToString_reuse)->Arg(1)->Arg(0);
+
+static void BM_dateToString(benchmark::State & state) {
+    AllocationCounter allocs(state);
+    for(auto _ : state) {
+        benchmark::DoNotOptimize(ofxSunCalc::dateToString(bench_date));
+    }
+}
+BENCHMARK(BM_dateToString);
+
+static void BM_dateToDateString(benchmark::State & state) {
+    AllocationCounter allocs(state);
+    for(auto _ : state) {
+        benchmark::DoNotOptimize(ofxSunCalc::dateToDateString(bench_date));
+    }
+}
+BENCHMARK(BM_dateToDateString);
+
+static void BM_dateToTimeString(benchmark::State & state) {
+    AllocationCounter allocs(state);
+    for(auto _ : state) {
+        benchmark::DoNotOptimize(ofxSunCalc::dateToTimeString(bench_date));
+    }
+}
+BENCHMARK(BM_dateToTimeString);
+
+static void BM_dateToTimeChars(benchmark::State & state) {
+    char buf[ofxSunCalcFormat::timeSize];
+    AllocationCounter allocs(state);
+    for(auto _ : state) {
+        benchmark::DoNotOptimize(ofxSunCalc::dateToTimeChars(bench_date, buf));
+        benchmark::ClobberMemory();
+    }
+}
+BENCHMARK(BM_dateToTimeChars);
+
+static void BM_julianDateToChars(benchmark::State & state) {
+    double J = ofxSunCalc().dateToJulianDate(bench_date);
+    char buf[ofxSunCalcFormat::dateTimeSize];
+    AllocationCounter allocs(state);
+    for(auto _ : state) {
+        benchmark::DoNotOptimize(ofxSunCalcFormat::julianDateToChars(J, buf));
+        benchmark::ClobberMemory();
+    }
+}
+BENCHMARK(BM_julianDateToChars);
+
+//========================================================================
+// brightness
+
+static void BM_getSunBrightness(benchmark::State & state) {
+    ofxSunCalc sun_calc;
+    SunCalcDayInfo info = sun_calc.getDayInfo(bench_date, argLat(state), bench_lon, false);
+    AllocationCounter allocs(state);
+    for(auto _ : state) {
+        benchmark::DoNotOptimize(ofxSunCalc::getSunBrightness(info, bench_date));
+    }
+}
+BENCHMARK(BM_getSunBrightness)->Apply(latitudeSweep);
+
+// per fixture cost, range(0) = lookups per call spread over the day
+static void BM_brightnessTable(benchmark::State & state) {
+    ofxSunCalc sun_calc;
+    ofxSunCalcBrightnessTable table = sun_calc.getBrightnessTable(bench_date, -33.8647, bench_lon);
+    size_t count = state.range(0);
+    std::vector<double> J(count);
+    std::vector<float> out(count);
+    for(size_t i = 0; i < count; i++) {
+        J[i] = table.getStartJulianDate() + (double)i / count;
+    }
+    AllocationCounter allocs(state);
+    for(auto _ : state) {
+        table.getBrightness(J.data(), count, out.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK(BM_brightnessTable)->Arg(256);
+
+// range(0) days in one mesh, the year at a glance dashboard case
+static void BM_timelineHeatmap(benchmark::State & state) {
+    SunCalcSite site = { -33.8647, bench_lon };
+    double J0 = std::floor(bench_date.julianDay() - 0.5) + 0.5;
+    int days = state.range(0);
+    for(auto _ : state) {
+        ofMesh mesh = ofxSunCalcTimeline::buildHeatmap(site, J0, days, ofRectangle(0, 0, 1024, 365));
+        benchmark::DoNotOptimize(mesh.getNumVertices());
+    }
+    state.SetItemsProcessed(state.iterations() * days);
+}
+BENCHMARK(BM_timelineHeatmap)->Arg(1)->Arg(365)->Unit(benchmark::kMicrosecond);
+
+//========================================================================
+BENCHMARK_MAIN();
@@ -10,7 +10,6 @@
     TODO:  
         * Show the azimuth postition (angle of sun)
         * Sun rise / set position in sky (against horizon?)
-        * Draw and extended timeline
  
  */
 
@@ -62,8 +61,18 @@ void ofApp::setup(){
     for(int i = 0; i<4; i++) {
         timelines.push_back(ofFbo());
         timelines[i].allocate(ofGetWidth() - 20 - 110, 32);
-        ofxSunCalc::drawSimpleDayInfoTimeline(timelines[i], sun_infos[i]);
+        if(i == 2) { // today, with all the twilights
+            ofxSunCalc::drawExtendedDayInfoTimeline(timelines[i], sun_infos[i]);
+        }else{
+            ofxSunCalc::drawSimpleDayInfoTimeline(timelines[i], sun_infos[i]);
+        }
     }
+    
+    SunCalcSite site;
+    site.lat = lat;
+    site.lon = lon;
+    year_heatmap_rect.set(ofGetWidth() - 10 - 680, 10, 680, 290);
+    year_heatmap = ofxSunCalcTimeline::buildHeatmap(site, floor(now.julianDay() - 0.5) + 0.5, 365, year_heatmap_rect);
 
 }
 
@@ -80,10 +89,11 @@ void ofApp::updateDebugStrings( Poco::LocalDateTime &date ) {
     
     pos_str = "altitude=" + ofToString(sunpos.altitude) + ", azimuth=" + ofToString(sunpos.azimuth * RAD_TO_DEG);
     
-    todayInfo = sun_calc.getDayInfo(date, lat, lon, true);
+    todayInfo = day_info_cache.getDayInfo(date, lat, lon, true);
     
-    min_info_str = sun_calc.infoToString(todayInfo, true);
-    max_info_str = sun_calc.infoToString(todayInfo, false);    
+    // refill the existing strings, no per frame allocation once their capacity has settled
+    sun_calc.infoToString(todayInfo, min_info_str, true);
+    sun_calc.infoToString(todayInfo, max_info_str, false);
 }
 
 //--------------------------------------------------------------
@@ -133,6 +143,10 @@ void ofApp::draw(){
     
     ofDrawBitmapStringHighlight("Current Brightness " + ofToString(sun_brightness, 3), 195, 70, ofColor::goldenRod, ofColor::white);
     
+    ofSetColor(255);
+    year_heatmap.draw();
+    ofDrawBitmapStringHighlight("Next 365 days (UTC)", year_heatmap_rect.x + 5, year_heatmap_rect.y + 15);
+    
     float tx = 10 + 110;
     float ty = 320;
     for(int i = 0; i<timelines.size(); i++) {
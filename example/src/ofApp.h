@@ -2,6 +2,7 @@
 
 #include "ofMain.h"
 #include "ofxSunCalc.h"
+#include "ofxSunCalcDayInfoCache.h"
 
 class ofApp : public ofBaseApp{
 
@@ -23,6 +24,7 @@ class ofApp : public ofBaseApp{
         void updateDebugStrings( Poco::LocalDateTime &date );
     
         ofxSunCalc sun_calc;
+        ofxSunCalcDayInfoCache day_info_cache; // todayInfo is asked for every frame
         SunCalcDayInfo todayInfo;
         
         string min_info_str;
@@ -34,6 +36,9 @@ class ofApp : public ofBaseApp{
         vector<ofFbo> timelines;
         vector<string> labels;
         
+        ofMesh year_heatmap; // a row per day for the coming year, built once
+        ofRectangle year_heatmap_rect;
+        
         float lat;
         float lon;
     
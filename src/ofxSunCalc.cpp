@@ -1,5 +1,69 @@
 
 #include "ofxSunCalc.h"
+#include "ofxSunCalcFastMath.h"
+
+using namespace ofxSunCalcCore;
+
+namespace {
+    
+    // Per sample kernels for the fast batch paths, kept as free functions so they can be
+    // cloned per instruction set (see OFX_SUNCALC_VECTORIZE).
+    
+    OFX_SUNCALC_VECTORIZE
+    void sunPositionsFastKernel( double Ha, double sind, double cosd, double tand,
+                                 const double * __restrict lw, const double * __restrict phi, size_t count,
+                                 double * __restrict azimuth, double * __restrict altitude ) {
+        namespace F = ofxSunCalcFastMath;
+        for(size_t i = 0; i < count; i++) {
+            double H = Ha - lw[i];
+            double sinH = F::sin(H);
+            double cosH = F::cos(H);
+            double sinphi = F::sin(phi[i]);
+            double cosphi = F::cos(phi[i]);
+            azimuth[i] = F::atan2(sinH, cosH * sinphi - tand * cosphi);
+            altitude[i] = F::asin(sinphi * sind + cosphi * cosd * cosH);
+        }
+    }
+    
+    OFX_SUNCALC_VECTORIZE
+    void moonPositionsFastKernel( const double * __restrict J, const double * __restrict lw, const double * __restrict phi, size_t count,
+                                  double * __restrict azimuth, double * __restrict altitude,
+                                  double J2000, double deg2rad, double e ) {
+        namespace F = ofxSunCalcFastMath;
+        double sine = F::sin(e);
+        double cose = F::cos(e);
+        for(size_t i = 0; i < count; i++) {
+            double d = J[i] - J2000;
+            double L = deg2rad * (218.316 + 13.176396 * d);
+            double M = deg2rad * (134.963 + 13.064993 * d);
+            double Fm = deg2rad * (93.272 + 13.229350 * d);
+            
+            double l = L + deg2rad * 6.289 * F::sin(M);
+            double b = deg2rad * 5.128 * F::sin(Fm);
+            double sinl = F::sin(l);
+            double sinb = F::sin(b);
+            double cosb = F::cos(b);
+            
+            double ra = F::atan2(sinl * cose - (sinb / cosb) * sine, F::cos(l));
+            double dec = F::asin(sinb * cose + cosb * sine * sinl);
+            
+            double H = deg2rad * (280.16 + 360.9856235 * d) - lw[i] - ra;
+            double sinH = F::sin(H);
+            double cosH = F::cos(H);
+            double sinphi = F::sin(phi[i]);
+            double cosphi = F::cos(phi[i]);
+            double sindec = F::sin(dec);
+            double cosdec = F::cos(dec);
+            
+            double h = F::asin(sinphi * sindec + cosphi * cosdec * cosH);
+            double hr = 0.5 * (h + std::fabs(h)); // astroRefraction, max(h, 0) without a branch
+            
+            azimuth[i] = F::atan2(sinH, cosH * sinphi - (sindec / cosdec) * cosphi);
+            altitude[i] = h + 0.0002967 / F::tan(hr + 0.00312536 / (hr + 0.08901179));
+        }
+    }
+    
+}
 
 ofxSunCalc::ofxSunCalc() {
 }
@@ -9,6 +73,8 @@ double ofxSunCalc::dateToJulianDate( const Poco::DateTime & date ) {
 }
 
 Poco::DateTime ofxSunCalc::julianDateToDate( double j ) {
+    OFX_SUNCALC_STATS_SCOPE(JULIAN_DATE_TO_DATE);
+    OFX_SUNCALC_STATS_SENTINEL(JULIAN_DATE_TO_DATE, std::isnan(j));
     if(!std::isnan(j)){
         return Poco::DateTime(j); // + 0.5 - J1970);
     }else{
@@ -17,209 +83,345 @@ Poco::DateTime ofxSunCalc::julianDateToDate( double j ) {
 }
 
 int ofxSunCalc::getJulianCycle( double J, double lw ) {
-    return round(J - J2000 - J0 - lw/(2 * PI));
+    return ofxSunCalcCore::getJulianCycle(J, lw);
 }
 
 double ofxSunCalc::getApproxSolarTransit( double Ht, double lw, double n ) {
-    return J2000 + J0 + (Ht + lw)/(2 * PI) + n;
+    return ofxSunCalcCore::getApproxSolarTransit(Ht, lw, n);
 }
 
 double ofxSunCalc::getSolarMeanAnomaly( double Js ) {
-    return M0 + M1 * (Js - J2000);
+    return ofxSunCalcCore::getSolarMeanAnomaly(Js);
 }
 
 double ofxSunCalc::getEquationOfCenter( double M ) {
-    return C1 * sin(M) + C2 * sin(2 * M) + C3 * sin(3 * M);
+    return ofxSunCalcCore::getEquationOfCenter(M);
 }
 
 double ofxSunCalc::getEclipticLongitude( double M, double C ) {
-    return M + P + C + PI;
+    return ofxSunCalcCore::getEclipticLongitude(M, C);
 }
 
 double ofxSunCalc::getSolarTransit( double Js, double M, double Lsun ) {
-    return Js + (J1 * sin(M)) + (J2 * sin(2 * Lsun));
+    return ofxSunCalcCore::getSolarTransit(Js, M, Lsun);
 }
 
 double ofxSunCalc::getSunDeclination( double Lsun ) {
-    return asin(sin(Lsun) * sin(e));
+    return ofxSunCalcCore::getSunDeclination(Lsun);
 }
 
 double ofxSunCalc::getRightAscension( double Lsun ) {
-    return atan2(sin(Lsun) * cos(e), cos(Lsun));
+    return ofxSunCalcCore::getRightAscension(Lsun);
 }
 
 double ofxSunCalc::getSiderealTime( double J, double lw ) {
-    return th0 + th1 * (J - J2000) - lw;
+    return ofxSunCalcCore::getSiderealTime(J, lw);
 }
 
 double ofxSunCalc::getAzimuth( double th, double a, double phi, double d ) {
-    double H = th - a;
-    return atan2(sin(H), cos(H) * sin(phi) - tan(d) * cos(phi));
+    return ofxSunCalcCore::getAzimuth(th, a, phi, d);
 }
 
 double ofxSunCalc::getAltitude( double th, double a, double phi, double d ) {
-    double H = th - a;
-    return asin(sin(phi) * sin(d) + cos(phi) * cos(d) * cos(H));
+    return ofxSunCalcCore::getAltitude(th, a, phi, d);
 }
 
 double ofxSunCalc::getHourAngle( double h, double phi, double d ) {
-    return acos((sin(h) - sin(phi) * sin(d)) / (cos(phi) * cos(d)));
+    return ofxSunCalcCore::getHourAngle(h, phi, d);
 }
 
 double ofxSunCalc::getSunsetJulianDate( double w0, double M, double Lsun, double lw, double n ) {
-    return getSolarTransit( getApproxSolarTransit(w0, lw, n), M, Lsun );
+    return ofxSunCalcCore::getSunsetJulianDate(w0, M, Lsun, lw, n);
 }
 
 double ofxSunCalc::getSunriseJulianDate( double Jtransit, double Jset ) {
-    return Jtransit - (Jset - Jtransit);
+    return ofxSunCalcCore::getSunriseJulianDate(Jtransit, Jset);
 }
 
 SunCalcPosition ofxSunCalc::getSunPosition( const Poco::DateTime & date, double lat, double lon ) {
-    return getSunPosition( dateToJulianDate(date), -lon * deg2rad, lat * deg2rad );
+    OFX_SUNCALC_STATS_SCOPE(SUN_POSITION);
+    SunCalcPosition pos = ofxSunCalcCore::getSunPosition( dateToJulianDate(date), -lon * deg2rad, lat * deg2rad );
+    OFX_SUNCALC_STATS_SENTINEL(SUN_POSITION, std::isnan(pos.altitude));
+    return pos;
 }
 
 SunCalcPosition ofxSunCalc::getSunPosition( double J, double lw, double phi ) {
-    double M = getSolarMeanAnomaly(J);
-    double C = getEquationOfCenter(M);
-    double Lsun = getEclipticLongitude(M, C);
-    double d = getSunDeclination(Lsun);
-    double a = getRightAscension(Lsun);
-    double th = getSiderealTime(J, lw);
-    
-    SunCalcPosition pos;
-    pos.azimuth = getAzimuth( th, a, phi, d );
-    pos.altitude = getAltitude( th, a, phi, d );
+    OFX_SUNCALC_STATS_SCOPE(SUN_POSITION);
+    SunCalcPosition pos = ofxSunCalcCore::getSunPosition(J, lw, phi);
+    OFX_SUNCALC_STATS_SENTINEL(SUN_POSITION, std::isnan(pos.altitude));
     return pos;
 }
 
-double ofxSunCalc::rightAscension(double l, double b) { return atan2(sin(l) * cos(e) - tan(b) * sin(e), cos(l)); }
-double ofxSunCalc::declination(double l, double b){ return asin(sin(b) * cos(e) + cos(b) * sin(e) * sin(l)); }
-double ofxSunCalc::azimuth(double H, double phi, double dec)  { return atan2(sin(H), cos(H) * sin(phi) - tan(dec) * cos(phi)); }
-double ofxSunCalc::altitude(double H, double phi, double dec) { return asin(sin(phi) * sin(dec) + cos(phi) * cos(dec) * cos(H)); }
-double ofxSunCalc::siderealTime(double d, double lw) { return deg2rad * (280.16 + 360.9856235 * d) - lw; }
-double ofxSunCalc::astroRefraction(double h) {
-    if (h < 0) // the following formula works for positive altitudes only.
-        h = 0; // if h = -0.08901179 a div/0 would occur.
-    
-    // formula 16.4 of "Astronomical Algorithms" 2nd edition by Jean Meeus (Willmann-Bell, Richmond) 1998.
-    // 1.02 / tan(h + 10.26 / (h + 5.10)) h in degrees, result in arc minutes -> converted to rad:
-    return 0.0002967 / tan(h + 0.00312536 / (h + 0.08901179));
+SunCalcPosition ofxSunCalc::getSunPosition( const Poco::DateTime & date, double lat, double lon, SunCalcAccuracy accuracy ) {
+    OFX_SUNCALC_STATS_SCOPE(SUN_POSITION);
+    SunCalcPosition pos = ofxSunCalcCore::getSunPosition( dateToJulianDate(date), -lon * deg2rad, lat * deg2rad, accuracy );
+    OFX_SUNCALC_STATS_SENTINEL(SUN_POSITION, std::isnan(pos.altitude));
+    return pos;
+}
+
+SunCalcPosition ofxSunCalc::getSunPosition( const Poco::DateTime & date, const SunCalcObserver & observer, SunCalcAccuracy accuracy ) {
+    OFX_SUNCALC_STATS_SCOPE(SUN_POSITION);
+    SunCalcPosition pos = ofxSunCalcCore::getSunPosition( dateToJulianDate(date), observer, accuracy );
+    OFX_SUNCALC_STATS_SENTINEL(SUN_POSITION, std::isnan(pos.altitude));
+    return pos;
 }
 
+void ofxSunCalc::getSunPositions( const double * J, const double * lw, const double * phi, size_t count, double * azimuth, double * altitude ) {
+    size_t i = 0;
+    while(i < count) {
+        // group consecutive samples sharing the same J so the per J work is only done once
+        size_t run = i + 1;
+        while(run < count && J[run] == J[i]) run++;
+        getSunPositions( J[i], lw + i, phi + i, run - i, azimuth + i, altitude + i );
+        i = run;
+    }
+}
 
-MoonCalcPosition ofxSunCalc::getMoonPosition( const Poco::DateTime & date, double lat, double lng){
-    
-    double rad = deg2rad;
-    double lw  = rad * -lng;
-    double phi = rad * lat;
-    double d = dateToJulianDate(date) - J2000;
-    
-        // function moonCoord(d)
-        double L = rad * (218.316 + 13.176396 * d); // ecliptic longitude
-        double M = rad * (134.963 + 13.064993 * d); // mean anomaly
-        double F = rad * (93.272 + 13.229350 * d);  // mean distance
-        
-        double l = L + rad * 6.289 * sin(M);    // longitude
-        double b = rad * 5.128 * sin(F);        // latitude
-        double dt = 385001 - 20905 * cos(M);    // distance to the moon in km
-        
-        double ra = rightAscension(l, b);
-        double dec = declination(l,b);
-        double dist = dt;
-    
-    double H = siderealTime(d, lw) - ra;
-    double h = altitude(H, phi, dec);
+void ofxSunCalc::getSunPositions( double J, const double * lw, const double * phi, size_t count, double * azimuth, double * altitude ) {
+    double M = ofxSunCalcCore::getSolarMeanAnomaly(J);
+    double C = ofxSunCalcCore::getEquationOfCenter(M);
+    double Lsun = ofxSunCalcCore::getEclipticLongitude(M, C);
+    double d = ofxSunCalcCore::getSunDeclination(Lsun);
+    double a = ofxSunCalcCore::getRightAscension(Lsun);
+    
+    // everything that only depends on J, hoisted out of the per sample loop
+    double Ha = ofxSunCalcCore::getSiderealTime(J, 0) - a;
+    double sind = sin(d);
+    double cosd = cos(d);
+    double tand = tan(d);
+    
+    const double * __restrict lw_ = lw;
+    const double * __restrict phi_ = phi;
+    double * __restrict az_ = azimuth;
+    double * __restrict alt_ = altitude;
+    
+    for(size_t i = 0; i < count; i++) {
+        double H = Ha - lw_[i];
+        double sinH = sin(H);
+        double cosH = cos(H);
+        double sinphi = sin(phi_[i]);
+        double cosphi = cos(phi_[i]);
+        az_[i] = atan2(sinH, cosH * sinphi - tand * cosphi);
+        alt_[i] = asin(sinphi * sind + cosphi * cosd * cosH);
+    }
+}
+
+void ofxSunCalc::getSunPositionsFast( const double * J, const double * lw, const double * phi, size_t count, double * azimuth, double * altitude ) {
+    size_t i = 0;
+    while(i < count) {
+        size_t run = i + 1;
+        while(run < count && J[run] == J[i]) run++;
+        getSunPositionsFast( J[i], lw + i, phi + i, run - i, azimuth + i, altitude + i );
+        i = run;
+    }
+}
+
+void ofxSunCalc::getSunPositionsFast( double J, const double * lw, const double * phi, size_t count, double * azimuth, double * altitude ) {
+    double M = ofxSunCalcCore::getSolarMeanAnomaly(J);
+    double C = ofxSunCalcCore::getEquationOfCenter(M);
+    double Lsun = ofxSunCalcCore::getEclipticLongitude(M, C);
+    double d = ofxSunCalcCore::getSunDeclination(Lsun);
+    double a = ofxSunCalcCore::getRightAscension(Lsun);
     
-    // formula 14.1 of "Astronomical Algorithms" 2nd edition by Jean Meeus (Willmann-Bell, Richmond) 1998.
-    double pa = atan2(sin(H), tan(phi) * cos(dec) - sin(dec) * cos(H));
-    h = h + astroRefraction(h); // altitude correction for refraction
+    sunPositionsFastKernel( ofxSunCalcCore::getSiderealTime(J, 0) - a, sin(d), cos(d), tan(d), lw, phi, count, azimuth, altitude );
+}
+
+void ofxSunCalc::getMoonPositionsFast( const double * J, const double * lw, const double * phi, size_t count, double * azimuth, double * altitude ) {
+    moonPositionsFastKernel( J, lw, phi, count, azimuth, altitude, J2000, deg2rad, e );
+}
 
-    MoonCalcPosition mp;
-    mp.azimuth =  azimuth(H, phi, dec);
-    mp.altitude =  h;
-    mp.distance = dist;
-    mp.parallacticAngle = pa;
-    return mp;
+void ofxSunCalc::sweepSunPositions( const SunCalcSite & site, double startJ, double stepSeconds, size_t count, SunCalcPosition * out ) {
+    ofxSunCalcCore::sweepSunPositions( site, startJ, stepSeconds, count, out );
+}
+
+MoonCalcPosition ofxSunCalc::getMoonPosition( const Poco::DateTime & date, double lat, double lon ) {
+    OFX_SUNCALC_STATS_SCOPE(MOON_POSITION);
+    MoonCalcPosition pos = ofxSunCalcCore::getMoonPosition( dateToJulianDate(date), -lon * deg2rad, lat * deg2rad );
+    OFX_SUNCALC_STATS_SENTINEL(MOON_POSITION, std::isnan(pos.altitude));
+    return pos;
+}
+
+MoonCalcPosition ofxSunCalc::getMoonPosition( const Poco::DateTime & date, double lat, double lon, SunCalcAccuracy accuracy ) {
+    OFX_SUNCALC_STATS_SCOPE(MOON_POSITION);
+    MoonCalcPosition pos = ofxSunCalcCore::getMoonPosition( dateToJulianDate(date), -lon * deg2rad, lat * deg2rad, accuracy );
+    OFX_SUNCALC_STATS_SENTINEL(MOON_POSITION, std::isnan(pos.altitude));
+    return pos;
+}
+
+MoonCalcPosition ofxSunCalc::getMoonPosition( const Poco::DateTime & date, const SunCalcObserver & observer, SunCalcAccuracy accuracy ) {
+    OFX_SUNCALC_STATS_SCOPE(MOON_POSITION);
+    MoonCalcPosition pos = ofxSunCalcCore::getMoonPosition( dateToJulianDate(date), observer, accuracy );
+    OFX_SUNCALC_STATS_SENTINEL(MOON_POSITION, std::isnan(pos.altitude));
+    return pos;
+}
+
+MoonCalcIllumination ofxSunCalc::getMoonIllumination( const Poco::DateTime & date ) {
+    return ofxSunCalcCore::getMoonIllumination( dateToJulianDate(date) );
+}
+
+MoonCalcDayInfo ofxSunCalc::getMoonDayInfo( const Poco::DateTime & date, double lat, double lon ) {
+    MoonCalcDayTimes times;
+    getMoonDayTimes( date, lat, lon, 1, &times );
+    return moonDayTimesToDayInfo( times, lat, lon );
+}
+
+MoonCalcDayInfo ofxSunCalc::getMoonDayInfo( const Poco::DateTime & date, const SunCalcObserver & observer ) {
+    MoonCalcDayTimes times;
+    getMoonDayTimes( date, observer, 1, &times );
+    return moonDayTimesToDayInfo( times, observer.lat, observer.lon );
+}
+
+void ofxSunCalc::getMoonDayTimes( const Poco::DateTime & date, double lat, double lon, int numDays, MoonCalcDayTimes * out ) {
+    double J0 = floor(dateToJulianDate(date) - 0.5) + 0.5; // 00:00 of the day
+    ofxSunCalcCore::getMoonTimes( J0, numDays, -lon * deg2rad, lat * deg2rad, out );
+}
+
+void ofxSunCalc::getMoonDayTimes( const Poco::DateTime & date, const SunCalcObserver & observer, int numDays, MoonCalcDayTimes * out ) {
+    double J0 = floor(dateToJulianDate(date) - 0.5) + 0.5; // 00:00 of the day
+    ofxSunCalcCore::getMoonTimes( J0, numDays, observer, out );
+}
+
+MoonCalcDayInfo ofxSunCalc::moonDayTimesToDayInfo( const MoonCalcDayTimes & times, double lat, double lon ) {
+    MoonCalcDayInfo info;
+    info.lat = lat;
+    info.lon = lon;
+    info.rise = julianDateToDate(times.rise);
+    info.set = julianDateToDate(times.set);
+    info.transit = julianDateToDate(times.transit);
+    info.alwaysUp = times.alwaysUp;
+    info.alwaysDown = times.alwaysDown;
+    return info;
 }
 
 SunCalcDayInfo ofxSunCalc::getDayInfo( const Poco::DateTime & date, double lat, double lon, bool detailed ) {
-    double lw = -lon * deg2rad;
-    double phi = lat * deg2rad;
-    double J = dateToJulianDate(date);
-
-    double n = getJulianCycle(J, lw);
-    double Js = getApproxSolarTransit(0, lw, n);
-    double M = getSolarMeanAnomaly(Js);
-    double C = getEquationOfCenter(M);
-    double Lsun = getEclipticLongitude(M, C);
-    double d = getSunDeclination(Lsun);
-    double Jtransit = getSolarTransit(Js, M, Lsun);
-    double w0 = getHourAngle(h0, phi, d);
-    double w1 = getHourAngle(h0 + d0, phi, d);
-    double Jset = getSunsetJulianDate(w0, M, Lsun, lw, n);
-    double Jsetstart = getSunsetJulianDate(w1, M, Lsun, lw, n);
-    double Jrise = getSunriseJulianDate(Jtransit, Jset);
-    double Jriseend = getSunriseJulianDate(Jtransit, Jsetstart);
-    double w2 = getHourAngle(h1, phi, d);
-    double Jnau = getSunsetJulianDate(w2, M, Lsun, lw, n);
-    double Jciv2 = getSunriseJulianDate(Jtransit, Jnau);
+    OFX_SUNCALC_STATS_SCOPE(DAY_INFO);
+    SunCalcDayTimes times = getDayTimes(date, lat, lon, detailed);
+    OFX_SUNCALC_STATS_SENTINEL(DAY_INFO, times.polarDay || times.polarNight);
+    return dayTimesToDayInfo( times, lat, lon );
+}
 
+SunCalcDayInfo ofxSunCalc::getDayInfo( const Poco::DateTime & date, const SunCalcObserver & observer, bool detailed ) {
+    OFX_SUNCALC_STATS_SCOPE(DAY_INFO);
+    SunCalcDayTimes times = getDayTimes(date, observer, detailed);
+    OFX_SUNCALC_STATS_SENTINEL(DAY_INFO, times.polarDay || times.polarNight);
+    return dayTimesToDayInfo( times, observer.lat, observer.lon );
+}
+
+SunCalcDayTimes ofxSunCalc::getDayTimes( const Poco::DateTime & date, double lat, double lon, bool detailed ) {
+    return ofxSunCalcCore::getDayTimes( dateToJulianDate(date), -lon * deg2rad, lat * deg2rad, detailed );
+}
+
+SunCalcDayTimes ofxSunCalc::getDayTimes( const Poco::DateTime & date, const SunCalcObserver & observer, bool detailed ) {
+    return ofxSunCalcCore::getDayTimes( dateToJulianDate(date), observer, detailed );
+}
+
+ofxSunCalcLazyDay ofxSunCalc::getLazyDay( const Poco::DateTime & date, double lat, double lon ) {
+    return ofxSunCalcLazyDay( dateToJulianDate(date), -lon * deg2rad, lat * deg2rad );
+}
+
+ofxSunCalcLazyDay ofxSunCalc::getLazyDay( const Poco::DateTime & date, const SunCalcObserver & observer ) {
+    return ofxSunCalcLazyDay( dateToJulianDate(date), observer );
+}
+
+SunCalcDayInfo ofxSunCalc::dayTimesToDayInfo( const SunCalcDayTimes & times, double lat, double lon ) {
     SunCalcDayInfo info;
     
     info.lat = lat;
     info.lon = lon;
-    
-    info.dawn = julianDateToDate(Jciv2);
-    info.sunrise.start = julianDateToDate(Jrise);
-    info.sunrise.end = julianDateToDate(Jriseend);
-    info.transit = julianDateToDate(Jtransit);
-    info.sunset.start = julianDateToDate(Jsetstart);
-    info.sunset.end = julianDateToDate(Jset);
-    info.dusk = julianDateToDate(Jnau);
-
-    if(detailed){
-        double w3 = getHourAngle(h2, phi, d);
-        double w4 = getHourAngle(h3, phi, d);
-        double Jastro = getSunsetJulianDate(w3, M, Lsun, lw, n);
-        double Jdark = getSunsetJulianDate(w4, M, Lsun, lw, n);
-        double Jnau2 = getSunriseJulianDate(Jtransit, Jastro);
-        double Jastro2 = getSunriseJulianDate(Jtransit, Jdark);
-        
+    info.polarDay = times.polarDay;
+    info.polarNight = times.polarNight;
+    
+    info.dawn = julianDateToDate(times.dawn);
+    info.sunrise.start = julianDateToDate(times.sunriseStart);
+    info.sunrise.end = julianDateToDate(times.sunriseEnd);
+    info.transit = julianDateToDate(times.transit);
+    info.sunset.start = julianDateToDate(times.sunsetStart);
+    info.sunset.end = julianDateToDate(times.sunsetEnd);
+    info.dusk = julianDateToDate(times.dusk);
+
+    if(times.detailed){
         info.extended.isSet = true;
         
-        info.extended.morningTwilightAstronomical.start = julianDateToDate(Jastro2);
-        info.extended.morningTwilightAstronomical.end = julianDateToDate(Jnau2);
+        info.extended.morningTwilightAstronomical.start = julianDateToDate(times.nightEnd);
+        info.extended.morningTwilightAstronomical.end = julianDateToDate(times.nauticalDawn);
 
-        info.extended.morningTwilightNautical.start = julianDateToDate(Jnau2);
-        info.extended.morningTwilightNautical.end = julianDateToDate(Jciv2);
+        info.extended.morningTwilightNautical.start = info.extended.morningTwilightAstronomical.end;
+        info.extended.morningTwilightNautical.end = info.dawn;
         
-        info.extended.morningTwilightCivil.start = julianDateToDate(Jciv2);
-        info.extended.morningTwilightCivil.end = julianDateToDate(Jrise);
+        info.extended.morningTwilightCivil.start = info.dawn;
+        info.extended.morningTwilightCivil.end = info.sunrise.start;
       
-        info.extended.nightTwilightCivil.start = julianDateToDate(Jset);
-        info.extended.nightTwilightCivil.end = julianDateToDate(Jnau);
+        info.extended.nightTwilightCivil.start = info.sunset.end;
+        info.extended.nightTwilightCivil.end = info.dusk;
         
-        info.extended.nightTwilightNautical.start = julianDateToDate(Jnau);
-        info.extended.nightTwilightNautical.end = julianDateToDate(Jastro);
+        info.extended.nightTwilightNautical.start = info.dusk;
+        info.extended.nightTwilightNautical.end = julianDateToDate(times.nauticalDusk);
        
-        info.extended.nightTwilightAstronomical.start = julianDateToDate(Jastro);
-        info.extended.nightTwilightAstronomical.end = julianDateToDate(Jdark);
+        info.extended.nightTwilightAstronomical.start = info.extended.nightTwilightNautical.end;
+        info.extended.nightTwilightAstronomical.end = julianDateToDate(times.nightStart);
     }
     
     return info;
 }
 
 
+SunCalcAltitudeTimes ofxSunCalc::getAltitudeTimes( const Poco::DateTime & date, double lat, double lon, double altitude ) {
+    return ofxSunCalcCore::getAltitudeTimes( dateToJulianDate(date), -lon * deg2rad, lat * deg2rad, altitude );
+}
+
+size_t ofxSunCalc::getAzimuthTimes( const Poco::DateTime & date, double lat, double lon, double azimuth, double * out, size_t maxCount ) {
+    double J0 = std::floor(dateToJulianDate(date) - 0.5) + 0.5;
+    return ofxSunCalcCore::getAzimuthTimes( J0, J0 + 1, -lon * deg2rad, lat * deg2rad, azimuth, out, maxCount );
+}
+
 string ofxSunCalc::infoToString(const SunCalcDayInfo & info, bool min ) {
-    ostringstream out;
+    string out;
+    infoToString(info, out, min);
+    return out;
+}
+
+namespace {
+    
+    void appendTime( string & out, const Poco::DateTime & date ) {
+        char buf[ofxSunCalcFormat::timeSize];
+        out.append(buf, ofxSunCalc::dateToTimeChars(date, buf));
+    }
+    
+    void appendDate( string & out, const Poco::DateTime & date ) {
+        char buf[ofxSunCalcFormat::dateSize];
+        out.append(buf, ofxSunCalc::dateToDateChars(date, buf));
+    }
+    
+    void appendRange( string & out, const Poco::DateTime & start, const Poco::DateTime & end, const char * label ) {
+        appendTime(out, start);
+        out += '-';
+        appendTime(out, end);
+        out += label;
+    }
+    
+}
+
+void ofxSunCalc::infoToString(const SunCalcDayInfo & info, string & out, bool min ) {
+    OFX_SUNCALC_STATS_SCOPE(INFO_TO_STRING);
+    OFX_SUNCALC_STATS_SENTINEL(INFO_TO_STRING, info.polarDay || info.polarNight);
+    out.clear();
     
     if(min) { // copy the suncalc.net legend min details widget
         
-        out << dateToTimeString(info.dawn) << " - dawn";
-        out << endl << dateToTimeString(info.sunrise.start) << " - sunrise";
-        out << endl << dateToTimeString(info.transit) << " - solar noon";
-        out << endl << dateToTimeString(info.sunset.end) << " - sunset";
-        out << endl << dateToTimeString(info.dusk) << " - dusk";
+        out.reserve(96);
+        appendTime(out, info.dawn);
+        out += " - dawn\n";
+        appendTime(out, info.sunrise.start);
+        out += " - sunrise\n";
+        appendTime(out, info.transit);
+        out += " - solar noon\n";
+        appendTime(out, info.sunset.end);
+        out += " - sunset\n";
+        appendTime(out, info.dusk);
+        out += " - dusk";
+        
+        if(info.polarDay) out += "\npolar day";
+        if(info.polarNight) out += "\npolar night";
         
     }else{
       /*  out << "dawn = " << dateToString(info.dawn) << endl;
@@ -228,24 +430,37 @@ string ofxSunCalc::infoToString(const SunCalcDayInfo & info, bool min ) {
         out << "sunset: " << dateToString(info.sunset.start) << " -> " << dateToString(info.sunset.end) << endl;
         out << "dusk = " << dateToString(info.dusk);*/
         
-        out << "00:00-" << dateToTimeString(info.extended.morningTwilightAstronomical.start) << " - night" << endl;
-        out << dateToTimeString(info.extended.morningTwilightAstronomical.start) << "-" << dateToTimeString(info.extended.morningTwilightAstronomical.end) << " - astronomical twilight" << endl;
-        out << dateToTimeString(info.extended.morningTwilightNautical.start) << "-" << dateToTimeString(info.extended.morningTwilightNautical.end) << " - nautical twilight" << endl;
-        out << dateToTimeString(info.extended.morningTwilightCivil.start) << "-" << dateToTimeString(info.extended.morningTwilightCivil.end) << " - civil twilight" << endl;
-        out << dateToTimeString(info.sunrise.start) << "-" << dateToTimeString(info.sunrise.end) << " - sunrise" << endl;
-        out << dateToTimeString(info.sunrise.end) << "-" << dateToTimeString(info.sunset.start) << " - daylight" << endl;
-        out << dateToTimeString(info.sunset.start) << "-" << dateToTimeString(info.sunset.end) << " - sunset" << endl;
-        out << dateToTimeString(info.extended.nightTwilightCivil.start) << "-" << dateToTimeString(info.extended.nightTwilightCivil.end) << " - civil twilight" << endl;
-        out << dateToTimeString(info.extended.nightTwilightNautical.start) << "-" << dateToTimeString(info.extended.nightTwilightNautical.end) << " - nautical twilight" << endl;
-        out << dateToTimeString(info.extended.nightTwilightAstronomical.start) << "-" << dateToTimeString(info.extended.nightTwilightAstronomical.end) << " - astronomical twilight" << endl;
-        out << dateToTimeString(info.extended.nightTwilightAstronomical.end) << "-00:00:00 - night" << endl;
+        const SunCalcDayInfoExtended & ext = info.extended;
+        
+        out.reserve(512);
+        out += "00:00-";
+        appendTime(out, ext.morningTwilightAstronomical.start);
+        out += " - night\n";
+        appendRange(out, ext.morningTwilightAstronomical.start, ext.morningTwilightAstronomical.end, " - astronomical twilight\n");
+        appendRange(out, ext.morningTwilightNautical.start, ext.morningTwilightNautical.end, " - nautical twilight\n");
+        appendRange(out, ext.morningTwilightCivil.start, ext.morningTwilightCivil.end, " - civil twilight\n");
+        appendRange(out, info.sunrise.start, info.sunrise.end, " - sunrise\n");
+        appendRange(out, info.sunrise.end, info.sunset.start, " - daylight\n");
+        appendRange(out, info.sunset.start, info.sunset.end, " - sunset\n");
+        appendRange(out, ext.nightTwilightCivil.start, ext.nightTwilightCivil.end, " - civil twilight\n");
+        appendRange(out, ext.nightTwilightNautical.start, ext.nightTwilightNautical.end, " - nautical twilight\n");
+        appendRange(out, ext.nightTwilightAstronomical.start, ext.nightTwilightAstronomical.end, " - astronomical twilight\n");
+        appendTime(out, ext.nightTwilightAstronomical.end);
+        out += "-00:00:00 - night\n";
         
-        out << dateToDateString(info.extended.morningTwilightAstronomical.start) << " - " << dateToDateString(info.extended.nightTwilightAstronomical.end) << " - date range";
+        appendDate(out, ext.morningTwilightAstronomical.start);
+        out += " - ";
+        appendDate(out, ext.nightTwilightAstronomical.end);
+        out += " - date range";
+        
+        if(info.polarDay) out += "\npolar day, the sun stays up";
+        if(info.polarNight) out += "\npolar night, the sun stays down";
     }
-    return out.str();
 }
 
 string ofxSunCalc::dateToString(const Poco::DateTime & date) {
+    OFX_SUNCALC_STATS_SCOPE(FORMAT);
+    OFX_SUNCALC_STATS_SENTINEL(FORMAT, date.year() == 0);
     if(date.year() == 0){
         return "n.a.";
     }else{
@@ -254,6 +469,8 @@ string ofxSunCalc::dateToString(const Poco::DateTime & date) {
 }
 
 string ofxSunCalc::dateToDateString(const Poco::DateTime & date) {
+    OFX_SUNCALC_STATS_SCOPE(FORMAT);
+    OFX_SUNCALC_STATS_SENTINEL(FORMAT, date.year() == 0);
     if(date.year() == 0){
         return "n.a.";
     }else{
@@ -262,6 +479,8 @@ string ofxSunCalc::dateToDateString(const Poco::DateTime & date) {
 }
 
 string ofxSunCalc::dateToTimeString(const Poco::DateTime & date) {
+    OFX_SUNCALC_STATS_SCOPE(FORMAT);
+    OFX_SUNCALC_STATS_SENTINEL(FORMAT, date.year() == 0);
     if(date.year() == 0){
         return "n.a.";
     }else{
@@ -269,34 +488,43 @@ string ofxSunCalc::dateToTimeString(const Poco::DateTime & date) {
     }
 }
 
-float ofxSunCalc::getSunBrightness(SunCalcDayInfo & info, const Poco::DateTime time) {
-
-    // NOTE: this method not scientific, just a linear approximating hack when sun is setting.
-    // TODO: do based on position and full twilights,
-    
-    int cur_mins = time.hour() * 60 + time.minute();
-    
-    int rise_start_mins = info.dawn.hour() * 60 + info.dawn.minute();
-    int rise_end_mins = info.sunrise.end.hour() * 60 + info.sunrise.end.minute();
-    
-    int set_start_mins = info.sunset.start.hour() * 60 + info.sunset.start.minute();
-    int set_end_mins = info.dusk.hour() * 60 + info.dusk.minute();
-    
-    // Work out if they are in night or day or a twilight
-    
-    if(cur_mins >= rise_start_mins && cur_mins <= rise_end_mins) {
-        return (cur_mins-rise_start_mins)/(float)(rise_end_mins-rise_start_mins); // sunrising
+size_t ofxSunCalc::dateToChars(const Poco::DateTime & date, char * out) {
+    OFX_SUNCALC_STATS_SCOPE(FORMAT);
+    OFX_SUNCALC_STATS_SENTINEL(FORMAT, date.year() == 0);
+    if(date.year() == 0){
+        return ofxSunCalcFormat::writeNotAvailable(out);
+    }else{
+        return ofxSunCalcFormat::formatDateTime(date.year(), date.month(), date.day(), date.hour(), date.minute(), date.second(), out);
     }
-    
-    if(cur_mins >= set_start_mins && cur_mins <= set_end_mins){
-        return 1 - (cur_mins-set_start_mins)/(float)(set_end_mins-set_start_mins); // sunsetting
+}
+
+size_t ofxSunCalc::dateToDateChars(const Poco::DateTime & date, char * out) {
+    OFX_SUNCALC_STATS_SCOPE(FORMAT);
+    OFX_SUNCALC_STATS_SENTINEL(FORMAT, date.year() == 0);
+    if(date.year() == 0){
+        return ofxSunCalcFormat::writeNotAvailable(out);
+    }else{
+        return ofxSunCalcFormat::formatDate(date.year(), date.month(), date.day(), out);
     }
-    
-    if(cur_mins < rise_start_mins || cur_mins > set_end_mins) {
-        return 0.0; // night
+}
+
+size_t ofxSunCalc::dateToTimeChars(const Poco::DateTime & date, char * out) {
+    OFX_SUNCALC_STATS_SCOPE(FORMAT);
+    OFX_SUNCALC_STATS_SENTINEL(FORMAT, date.year() == 0);
+    if(date.year() == 0){
+        return ofxSunCalcFormat::writeNotAvailable(out);
+    }else{
+        return ofxSunCalcFormat::formatTime(date.hour(), date.minute(), date.second(), out);
     }
-    
-    return 1.0; // day
+}
+
+float ofxSunCalc::getSunBrightness(SunCalcDayInfo & info, const Poco::DateTime time) {
+    return ofxSunCalcCore::getSunBrightness( time.julianDay(), -info.lon * deg2rad, info.lat * deg2rad );
+}
+
+ofxSunCalcBrightnessTable ofxSunCalc::getBrightnessTable( const Poco::DateTime & date, double lat, double lon, int samplesPerDay ) {
+    double J0 = std::floor(dateToJulianDate(date) - 0.5) + 0.5;
+    return ofxSunCalcBrightnessTable( J0, -lon * deg2rad, lat * deg2rad, samplesPerDay );
 }
 
 void ofxSunCalc::drawSimpleDayInfoTimeline(ofFbo & target, SunCalcDayInfo & info) {
@@ -395,7 +623,46 @@ void ofxSunCalc::drawSimpleDayInfoTimeline(ofFbo & target, SunCalcDayInfo & info
 }
 
 void ofxSunCalc::drawExtendedDayInfoTimeline(ofFbo & target, SunCalcDayInfo & info) {
-    // TODO: draw all extended twilights and details
     
+    ofPushStyle();
+    ofPushMatrix();
+    float hour_w = target.getWidth() / 24;
+    float fill_top = 22;
+    
+    static ofTrueTypeFont ofx_suncalc_font;
+    if(!ofx_suncalc_font.isLoaded()) {
+        ofx_suncalc_font.load(OF_TTF_MONO, 8, false);
+    }
+    
+    SunCalcSite site;
+    site.lat = info.lat;
+    site.lon = info.lon;
+    double day_start = std::floor(info.transit.julianDay() - 0.5) + 0.5;
+    
+    ofxSunCalcTimeline::Palette palette = ofxSunCalcTimeline::getDefaultPalette();
+    ofRectangle bands(0, fill_top, target.getWidth(), target.getHeight() - fill_top);
+    
+    ofMesh mesh = ofxSunCalcTimeline::buildDay(site, day_start, bands, true, palette);
+    ofxSunCalcTimeline::addHourMarkers(mesh, ofRectangle(1, 0, target.getWidth(), target.getHeight()), palette.markers);
+    
+    target.begin();
+    
+    ofClear(0,0,0);
+    ofSetColor(255);
+    mesh.draw();
     
+    for(int hr = 0; hr<24; hr++) {
+        float cx = (hr*hour_w)+1;
+        
+        // shadowed time label
+        ofSetColor(0);
+        ofx_suncalc_font.drawString(ofToString(hr) + ":00", cx + 4, 15);
+        ofSetColor(255);
+        ofx_suncalc_font.drawString(ofToString(hr) + ":00", cx + 3, 14);
+    }
+    
+    target.end();
+    
+    ofPopMatrix();
+    ofPopStyle();
 }
@@ -19,17 +19,17 @@
 #include "Poco/DateTime.h"
 #include "Poco/DateTimeFormatter.h"
 
-typedef struct {
-    double azimuth;
-    double altitude;
-} SunCalcPosition;
-
-typedef struct {
-    double azimuth;
-    double altitude;
-    double distance;
-    double parallacticAngle;
-} MoonCalcPosition;
+#include "ofxSunCalcCore.h"
+#include "ofxSunCalcAccuracy.h"
+#include "ofxSunCalcMoon.h"
+#include "ofxSunCalcFormat.h"
+#include "ofxSunCalcBrightness.h"
+#include "ofxSunCalcInverse.h"
+#include "ofxSunCalcLazyDay.h"
+#include "ofxSunCalcSweep.h"
+#include "ofxSunCalcPrecision.h"
+#include "ofxSunCalcStats.h"
+#include "ofxSunCalcTimeline.h"
 
 typedef struct {
     Poco::DateTime start;
@@ -59,11 +59,28 @@ typedef struct {
     
     SunCalcDayInfoExtended extended;
     
+    // sun up / down all day, sunrise and sunset are then unset (year 0, "n.a.")
+    bool polarDay = false;
+    bool polarNight = false;
+    
     double lat;
     double lon;
     
 } SunCalcDayInfo;
 
+typedef struct {
+    Poco::DateTime rise;
+    Poco::DateTime set;
+    Poco::DateTime transit;
+    bool alwaysUp;
+    bool alwaysDown;
+    
+    double lat;
+    double lon;
+    
+} MoonCalcDayInfo;
+
+// openFrameworks / Poco facing wrapper around ofxSunCalcCore.h, the math is in the core.
 class ofxSunCalc {
     
 public:
@@ -99,10 +116,63 @@ public:
     
     SunCalcPosition getSunPosition( const Poco::DateTime & date, double lat, double lon );
     SunCalcPosition getSunPosition( double J, double lw, double phi );
+    // At a chosen cost / accuracy tier (ofxSunCalcAccuracy.h), SUNCALC_ACCURACY_FAST is the above.
+    SunCalcPosition getSunPosition( const Poco::DateTime & date, double lat, double lon, SunCalcAccuracy accuracy );
+    // Fixed sites: an observer (ofxSunCalcCore::getObserver) carries the latitude trig, elevation
+    // and refraction, so nothing site dependent is recomputed per call.
+    SunCalcPosition getSunPosition( const Poco::DateTime & date, const SunCalcObserver & observer, SunCalcAccuracy accuracy = SUNCALC_ACCURACY_FAST );
+    
+    // Batch (structure of arrays) form of getSunPosition( J, lw, phi ).
+    // Results are written to the caller owned azimuth / altitude arrays, which must hold count values.
+    // Runs of equal J share the time dependent work (anomaly, declination, right ascension).
+    void getSunPositions( const double * J, const double * lw, const double * phi, size_t count, double * azimuth, double * altitude );
+    void getSunPositions( double J, const double * lw, const double * phi, size_t count, double * azimuth, double * altitude );
+    
+    // As above but using the vectorised polynomial trig of ofxSunCalcFastMath.h instead of libm.
+    void getSunPositionsFast( const double * J, const double * lw, const double * phi, size_t count, double * azimuth, double * altitude );
+    void getSunPositionsFast( double J, const double * lw, const double * phi, size_t count, double * azimuth, double * altitude );
+    
+    // Positions at startJ + i * stepSeconds for i < count at one site, out must hold count values.
+    // Steps the hour angle by rotation instead of evaluating the model per sample (ofxSunCalcSweep.h).
+    void sweepSunPositions( const SunCalcSite & site, double startJ, double stepSeconds, size_t count, SunCalcPosition * out );
     
     MoonCalcPosition getMoonPosition( const Poco::DateTime & date, double lat, double lon);
+    MoonCalcPosition getMoonPosition( const Poco::DateTime & date, double lat, double lon, SunCalcAccuracy accuracy );
+    MoonCalcPosition getMoonPosition( const Poco::DateTime & date, const SunCalcObserver & observer, SunCalcAccuracy accuracy = SUNCALC_ACCURACY_FAST );
+    
+    MoonCalcIllumination getMoonIllumination( const Poco::DateTime & date );
+    
+    // Moon rise / set / transit during the (00:00 - 24:00) day of date.
+    MoonCalcDayInfo getMoonDayInfo( const Poco::DateTime & date, double lat, double lon );
+    MoonCalcDayInfo getMoonDayInfo( const Poco::DateTime & date, const SunCalcObserver & observer );
+    // Julian date form for numDays consecutive days from the day of date, out must hold numDays entries.
+    void getMoonDayTimes( const Poco::DateTime & date, double lat, double lon, int numDays, MoonCalcDayTimes * out );
+    void getMoonDayTimes( const Poco::DateTime & date, const SunCalcObserver & observer, int numDays, MoonCalcDayTimes * out );
+    
+    // Batch moon azimuth / altitude (refraction corrected) using the vectorised polynomial trig.
+    void getMoonPositionsFast( const double * J, const double * lw, const double * phi, size_t count, double * azimuth, double * altitude );
     
     SunCalcDayInfo getDayInfo( const Poco::DateTime & date, double lat, double lon, bool detailed = false );
+    SunCalcDayInfo getDayInfo( const Poco::DateTime & date, const SunCalcObserver & observer, bool detailed = false );
+    
+    // Allocation / calendar free alternative to getDayInfo, all events as Julian dates.
+    SunCalcDayTimes getDayTimes( const Poco::DateTime & date, double lat, double lon, bool detailed = false );
+    SunCalcDayTimes getDayTimes( const Poco::DateTime & date, const SunCalcObserver & observer, bool detailed = false );
+    // Events of the same day computed one at a time when read, for when only a few are needed.
+    ofxSunCalcLazyDay getLazyDay( const Poco::DateTime & date, double lat, double lon );
+    ofxSunCalcLazyDay getLazyDay( const Poco::DateTime & date, const SunCalcObserver & observer );
+    // Calendar conversion of SunCalcDayTimes, for when DateTimes are actually needed.
+    SunCalcDayInfo dayTimesToDayInfo( const SunCalcDayTimes & times, double lat, double lon );
+    MoonCalcDayInfo moonDayTimesToDayInfo( const MoonCalcDayTimes & times, double lat, double lon );
+    
+    // When the sun rises / sets through altitude (radians) on the day of date, as Julian dates.
+    // See ofxSunCalcInverse.h for batches over many altitudes / days.
+    SunCalcAltitudeTimes getAltitudeTimes( const Poco::DateTime & date, double lat, double lon, double altitude );
+    
+    // When the sun's azimuth (radians, from south towards west) passes azimuth during the
+    // (00:00 - 24:00) day of date. Writes up to maxCount Julian dates to out, returns the count.
+    size_t getAzimuthTimes( const Poco::DateTime & date, double lat, double lon, double azimuth, double * out, size_t maxCount = 2 );
+    
     string infoToString(const SunCalcDayInfo & info, bool min = true);
     
     string static dateToString(const Poco::DateTime & date);
@@ -111,43 +181,29 @@ public:
     
     string static dateToTimeString(const Poco::DateTime & date);
     
+    // Allocation free forms of the above. infoToString clears and refills out, so a string reused
+    // every frame stops allocating once its capacity has grown. The dateTo*Chars write into out
+    // (ofxSunCalcFormat::dateTimeSize / dateSize / timeSize chars) and return the length.
+    void infoToString(const SunCalcDayInfo & info, string & out, bool min = true);
+    
+    size_t static dateToChars(const Poco::DateTime & date, char * out);
+    
+    size_t static dateToDateChars(const Poco::DateTime & date, char * out);
+    
+    size_t static dateToTimeChars(const Poco::DateTime & date, char * out);
+    
+    // 0 (night) -> 1 (day) from the sun's altitude at time, at info.lat / info.lon.
+    // See ofxSunCalcBrightness.h for the twilight curve.
     float static getSunBrightness(SunCalcDayInfo & info, const Poco::DateTime time);
     
+    // Brightness lookup table over the (00:00 - 24:00) day of date, for many O(1) queries.
+    ofxSunCalcBrightnessTable getBrightnessTable( const Poco::DateTime & date, double lat, double lon, int samplesPerDay = 1440 );
+    
     void static drawSimpleDayInfoTimeline(ofFbo & target, SunCalcDayInfo & info);
+    // All twilight bands of the (UTC) day of info.transit plus the sun altitude curve, built with
+    // ofxSunCalcTimeline. Use ofxSunCalcTimeline directly to keep the mesh, or batch many days.
     void static drawExtendedDayInfoTimeline(ofFbo & target, SunCalcDayInfo & info);
     
-private:
-    double rightAscension(double l, double b);
-    double declination(double l, double b);
-    double azimuth(double H, double phi, double dec);
-    double altitude(double H, double phi, double dec);
-    double siderealTime(double d, double lw);
-    double astroRefraction(double h);
-
-private:
-    
-    constexpr static double J1970 = 2440588;
-    constexpr static double J2000 = 2451545;
-    constexpr static double dayMs = 1000 * 60 * 60 * 24;
-    constexpr static double deg2rad = PI / 180.0;
-    constexpr static double M0 = 357.5291 * deg2rad;
-    constexpr static double M1 = 0.98560028 * deg2rad;
-    constexpr static double J0 = 0.0009;
-    constexpr static double J1 = 0.0053;
-    constexpr static double J2 = -0.0069;
-    constexpr static double C1 = 1.9148 * deg2rad;
-    constexpr static double C2 = 0.0200 * deg2rad;
-    constexpr static double C3 = 0.0003 * deg2rad;
-    constexpr static double P = 102.9372 * deg2rad;
-    constexpr static double e = 23.4397 * deg2rad; // obliquity of the Earth
-    constexpr static double th0 = 280.1600 * deg2rad;
-    constexpr static double th1 = 360.9856235 * deg2rad;
-    constexpr static double h0 = -0.833 * deg2rad; //sunset angle
-    constexpr static double d0 = 0.53 * deg2rad; //sun diameter
-    constexpr static double h1 = -6 * deg2rad; //nautical twilight angle
-    constexpr static double h2 = -12 * deg2rad; //astronomical twilight angle
-    constexpr static double h3 = -18 * deg2rad; //darkness angle
-    
 };
 
 #endif /* defined(__ofxSunCalc__) */
@@ -0,0 +1,598 @@
+#include "ofxSunCalcAccuracy.h"
+
+namespace {
+
+    using namespace ofxSunCalcCore;
+
+    constexpr double arcsec2rad = deg2rad / 3600;
+
+    // degrees to radians, reduced first so large polynomial values keep their precision
+    inline double degrees( double a ) {
+        return std::fmod(a, 360.0) * deg2rad;
+    }
+
+    //========================================================================
+    // VSOP87 earth, heliocentric ecliptic of date, truncated as in Meeus appendix III.
+    // term = A cos(B + C tau), tau in Julian millennia from J2000, A in 1e-8 rad / AU.
+
+    typedef struct {
+        double A;
+        double B;
+        double C;
+    } VsopTerm;
+
+    const VsopTerm L0[] = {
+        { 175347046, 0, 0 }, { 3341656, 4.6692568, 6283.0758500 }, { 34894, 4.62610, 12566.15170 },
+        { 3497, 2.7441, 5753.3849 }, { 3418, 2.8289, 3.5231 }, { 3136, 3.6277, 77713.7715 },
+        { 2676, 4.4181, 7860.4194 }, { 2343, 6.1352, 3930.2097 }, { 1324, 0.7425, 11506.7698 },
+        { 1273, 2.0371, 529.6910 }, { 1199, 1.1096, 1577.3435 }, { 990, 5.233, 5884.927 },
+        { 902, 2.045, 26.298 }, { 857, 3.508, 398.149 }, { 780, 1.179, 5223.694 },
+        { 753, 2.533, 5507.553 }, { 505, 4.583, 18849.228 }, { 492, 4.205, 775.523 },
+        { 357, 2.920, 0.067 }, { 317, 5.849, 11790.629 }, { 284, 1.899, 796.298 },
+        { 271, 0.315, 10977.079 }, { 243, 0.345, 5486.778 }, { 206, 4.806, 2544.314 },
+        { 205, 1.869, 5573.143 }, { 202, 2.458, 6069.777 }, { 156, 0.833, 213.299 },
+        { 132, 3.411, 2942.463 }, { 126, 1.083, 20.775 }, { 115, 0.645, 0.980 },
+        { 103, 0.636, 4694.003 }, { 102, 0.976, 15720.839 }, { 102, 4.267, 7.114 },
+        { 99, 6.21, 2146.17 }, { 98, 0.68, 155.42 }, { 86, 5.98, 161000.69 },
+        { 85, 1.30, 6275.96 }, { 85, 3.67, 71430.70 }, { 80, 1.81, 17260.15 },
+        { 79, 3.04, 12036.46 }, { 75, 1.76, 5088.63 }, { 74, 3.50, 3154.69 },
+        { 74, 4.68, 801.82 }, { 70, 0.83, 9437.76 }, { 62, 3.98, 8827.39 },
+        { 61, 1.82, 7084.90 }, { 57, 2.78, 6286.60 }, { 56, 4.39, 14143.50 },
+        { 56, 3.47, 6279.55 }, { 52, 0.19, 12139.55 }, { 52, 1.33, 1748.02 },
+        { 51, 0.28, 5856.48 }, { 49, 0.49, 1194.45 }, { 41, 5.37, 8429.24 },
+        { 41, 2.40, 19651.05 }, { 39, 6.17, 10447.39 }, { 37, 6.04, 10213.29 },
+        { 37, 2.57, 1059.38 }, { 36, 1.71, 2352.87 }, { 36, 1.78, 6812.77 },
+        { 33, 0.59, 17789.85 }, { 30, 0.44, 83996.85 }, { 30, 2.74, 1349.87 },
+        { 25, 3.16, 4690.48 }
+    };
+    const VsopTerm L1[] = {
+        { 628331966747.0, 0, 0 }, { 206059, 2.678235, 6283.075850 }, { 4303, 2.6351, 12566.1517 },
+        { 425, 1.590, 3.523 }, { 119, 5.796, 26.298 }, { 109, 2.966, 1577.344 },
+        { 93, 2.59, 18849.23 }, { 72, 1.14, 529.69 }, { 68, 1.87, 398.15 },
+        { 67, 4.41, 5507.55 }, { 59, 2.89, 5223.69 }, { 56, 2.17, 155.42 },
+        { 45, 0.40, 796.30 }, { 36, 0.47, 775.52 }, { 29, 2.65, 7.11 },
+        { 21, 5.34, 0.98 }, { 19, 1.85, 5486.78 }, { 19, 4.97, 213.30 },
+        { 17, 2.99, 6275.96 }, { 16, 0.03, 2544.31 }, { 16, 1.43, 2146.17 },
+        { 15, 1.21, 10977.08 }, { 12, 2.83, 1748.02 }, { 12, 3.26, 5088.63 },
+        { 12, 5.27, 1194.45 }, { 12, 2.08, 4694.00 }, { 11, 0.77, 553.57 },
+        { 10, 1.30, 6286.60 }, { 10, 4.24, 1349.87 }, { 9, 2.70, 242.73 },
+        { 9, 5.64, 951.72 }, { 8, 5.30, 2352.87 }, { 6, 2.65, 9437.76 },
+        { 6, 4.67, 4690.48 }
+    };
+    const VsopTerm L2[] = {
+        { 52919, 0, 0 }, { 8720, 1.0721, 6283.0758 }, { 309, 0.867, 12566.152 },
+        { 27, 0.05, 3.52 }, { 16, 5.19, 26.30 }, { 16, 3.68, 155.42 },
+        { 10, 0.76, 18849.23 }, { 9, 2.06, 77713.77 }, { 7, 0.83, 775.52 },
+        { 5, 4.66, 1577.34 }, { 4, 1.03, 7.11 }, { 4, 3.44, 5573.14 },
+        { 3, 5.14, 796.30 }, { 3, 6.05, 5507.55 }, { 3, 1.19, 242.73 },
+        { 3, 6.12, 529.69 }, { 3, 0.31, 398.15 }, { 3, 2.28, 553.57 },
+        { 2, 4.38, 5223.69 }, { 2, 3.75, 0.98 }
+    };
+    const VsopTerm L3[] = {
+        { 289, 5.844, 6283.076 }, { 35, 0, 0 }, { 17, 5.49, 12566.15 },
+        { 3, 5.20, 155.42 }, { 1, 4.72, 3.52 }, { 1, 5.30, 18849.23 },
+        { 1, 5.97, 242.73 }
+    };
+    const VsopTerm L4[] = {
+        { 114, 3.142, 0 }, { 8, 4.13, 6283.08 }, { 1, 3.84, 12566.15 }
+    };
+    const VsopTerm L5[] = {
+        { 1, 3.14, 0 }
+    };
+    const VsopTerm B0[] = {
+        { 280, 3.199, 84334.662 }, { 102, 5.422, 5507.553 }, { 80, 3.88, 5223.69 },
+        { 44, 3.70, 2352.87 }, { 32, 4.00, 1577.34 }
+    };
+    const VsopTerm B1[] = {
+        { 9, 3.90, 5507.55 }, { 6, 1.73, 5223.69 }
+    };
+    const VsopTerm R0[] = {
+        { 100013989, 0, 0 }, { 1670700, 3.0984635, 6283.0758500 }, { 13956, 3.05525, 12566.15170 },
+        { 3084, 5.1985, 77713.7715 }, { 1628, 1.1739, 5753.3849 }, { 1576, 2.8469, 7860.4194 },
+        { 925, 5.453, 11506.770 }, { 542, 4.564, 3930.210 }, { 472, 3.661, 5884.927 },
+        { 346, 0.964, 5507.553 }, { 329, 5.900, 5223.694 }, { 307, 0.299, 5573.143 },
+        { 243, 4.273, 11790.629 }, { 212, 5.847, 1577.344 }, { 186, 5.022, 10977.079 },
+        { 175, 3.012, 18849.228 }, { 110, 5.055, 5486.778 }, { 98, 0.89, 6069.78 },
+        { 86, 5.69, 15720.84 }, { 86, 1.27, 161000.69 }, { 65, 0.27, 17260.15 },
+        { 63, 0.92, 529.69 }, { 57, 2.01, 83996.85 }, { 56, 5.24, 71430.70 },
+        { 49, 3.25, 2544.31 }, { 47, 2.58, 775.52 }, { 45, 5.54, 9437.76 },
+        { 43, 6.01, 6275.96 }, { 39, 5.36, 4694.00 }, { 38, 2.39, 8827.39 },
+        { 37, 0.83, 19651.05 }, { 37, 4.90, 12139.55 }, { 36, 1.67, 12036.46 },
+        { 35, 1.84, 2942.46 }, { 33, 0.24, 7084.90 }, { 32, 0.18, 5088.63 },
+        { 32, 1.78, 398.15 }, { 28, 1.21, 6286.60 }, { 28, 1.90, 6279.55 },
+        { 26, 4.59, 10447.39 }
+    };
+    const VsopTerm R1[] = {
+        { 103019, 1.107490, 6283.075850 }, { 1721, 1.0644, 12566.1517 }, { 702, 3.142, 0 },
+        { 32, 1.02, 18849.23 }, { 31, 2.84, 5507.55 }, { 25, 1.32, 5223.69 },
+        { 18, 1.42, 1577.34 }, { 10, 5.91, 10977.08 }, { 9, 1.42, 6275.96 },
+        { 9, 0.27, 5486.78 }
+    };
+    const VsopTerm R2[] = {
+        { 4359, 5.7846, 6283.0758 }, { 124, 5.579, 12566.152 }, { 12, 3.14, 0 },
+        { 9, 3.63, 77713.77 }, { 6, 1.87, 5573.14 }, { 3, 5.47, 18849.23 }
+    };
+    const VsopTerm R3[] = {
+        { 145, 4.273, 6283.076 }, { 7, 3.92, 12566.15 }
+    };
+    const VsopTerm R4[] = {
+        { 4, 2.56, 6283.08 }
+    };
+
+    template<size_t N>
+    inline double vsopSum( const VsopTerm (&terms)[N], double tau ) {
+        double sum = 0;
+        for(size_t i = 0; i < N; i++) {
+            sum += terms[i].A * std::cos(terms[i].B + terms[i].C * tau);
+        }
+        return sum;
+    }
+
+    //========================================================================
+    // Moon, Meeus tables 47.A / 47.B: multiples of D, M, M', F and the coefficients in
+    // 1e-6 degrees (longitude, latitude) / 1e-3 km (distance). Ordered by size, so the LOW
+    // tier just sums a prefix.
+
+    typedef struct {
+        int8_t D, M, Mp, F;
+        int32_t l;
+        int32_t r;
+    } MoonTermLR;
+
+    typedef struct {
+        int8_t D, M, Mp, F;
+        int32_t b;
+    } MoonTermB;
+
+    const MoonTermLR moonLR[] = {
+        { 0, 0, 1, 0, 6288774, -20905355 }, { 2, 0, -1, 0, 1274027, -3699111 }, { 2, 0, 0, 0, 658314, -2955968 },
+        { 0, 0, 2, 0, 213618, -569925 }, { 0, 1, 0, 0, -185116, 48888 }, { 0, 0, 0, 2, -114332, -3149 },
+        { 2, 0, -2, 0, 58793, 246158 }, { 2, -1, -1, 0, 57066, -152138 }, { 2, 0, 1, 0, 53322, -170733 },
+        { 2, -1, 0, 0, 45758, -204586 }, { 0, 1, -1, 0, -40923, -129620 }, { 1, 0, 0, 0, -34720, 108743 },
+        { 0, 1, 1, 0, -30383, 104755 }, { 2, 0, 0, -2, 15327, 10321 }, { 0, 0, 1, 2, -12528, 0 },
+        { 0, 0, 1, -2, 10980, 79661 }, { 4, 0, -1, 0, 10675, -34782 }, { 0, 0, 3, 0, 10034, -23210 },
+        { 4, 0, -2, 0, 8548, -21636 }, { 2, 1, -1, 0, -7888, 24208 }, { 2, 1, 0, 0, -6766, 30824 },
+        { 1, 0, -1, 0, -5163, -8379 }, { 1, 1, 0, 0, 4987, -16675 }, { 2, -1, 1, 0, 4036, -12831 },
+        { 2, 0, 2, 0, 3994, -10445 }, { 4, 0, 0, 0, 3861, -11650 }, { 2, 0, -3, 0, 3665, 14403 },
+        { 0, 1, -2, 0, -2689, -7003 }, { 2, 0, -1, 2, -2602, 0 }, { 2, -1, -2, 0, 2390, 10056 },
+        { 1, 0, 1, 0, -2348, 6322 }, { 2, -2, 0, 0, 2236, -9884 }, { 0, 1, 2, 0, -2120, 5751 },
+        { 0, 2, 0, 0, -2069, 0 }, { 2, -2, -1, 0, 2048, -4950 }, { 2, 0, 1, -2, -1773, 4130 },
+        { 2, 0, 0, 2, -1595, 0 }, { 4, -1, -1, 0, 1215, -3958 }, { 0, 0, 2, 2, -1110, 0 },
+        { 3, 0, -1, 0, -892, 3258 }, { 2, 1, 1, 0, -810, 2616 }, { 4, -1, -2, 0, 759, -1897 },
+        { 0, 2, -1, 0, -713, -2117 }, { 2, 2, -1, 0, -700, 2354 }, { 2, 1, -2, 0, 691, 0 },
+        { 2, -1, 0, -2, 596, 0 }, { 4, 0, 1, 0, 549, -1423 }, { 0, 0, 4, 0, 537, -1117 },
+        { 4, -1, 0, 0, 520, -1571 }, { 1, 0, -2, 0, -487, -1739 }, { 2, 1, 0, -2, -399, 0 },
+        { 0, 0, 2, -2, -381, -4421 }, { 1, 1, 1, 0, 351, 0 }, { 3, 0, -2, 0, -340, 0 },
+        { 4, 0, -3, 0, 330, 0 }, { 2, -1, 2, 0, 327, 0 }, { 0, 2, 1, 0, -323, 1165 },
+        { 1, 1, -1, 0, 299, 0 }, { 2, 0, 3, 0, 294, 0 }, { 2, 0, -1, -2, 0, 8752 }
+    };
+
+    const MoonTermB moonB[] = {
+        { 0, 0, 0, 1, 5128122 }, { 0, 0, 1, 1, 280602 }, { 0, 0, 1, -1, 277693 },
+        { 2, 0, 0, -1, 173237 }, { 2, 0, -1, 1, 55413 }, { 2, 0, -1, -1, 46271 },
+        { 2, 0, 0, 1, 32573 }, { 0, 0, 2, 1, 17198 }, { 2, 0, 1, -1, 9266 },
+        { 0, 0, 2, -1, 8822 }, { 2, -1, 0, -1, 8216 }, { 2, 0, -2, -1, 4324 },
+        { 2, 0, 1, 1, 4200 }, { 2, 1, 0, -1, -3359 }, { 2, -1, -1, 1, 2463 },
+        { 2, -1, 0, 1, 2211 }, { 2, -1, -1, -1, 2065 }, { 0, 1, -1, -1, -1870 },
+        { 4, 0, -1, -1, 1828 }, { 0, 1, 0, 1, -1794 }, { 0, 0, 0, 3, -1749 },
+        { 0, 1, -1, 1, -1565 }, { 1, 0, 0, 1, -1491 }, { 0, 1, 1, 1, -1475 },
+        { 0, 1, 1, -1, -1410 }, { 0, 1, 0, -1, -1344 }, { 1, 0, 0, -1, -1335 },
+        { 0, 0, 3, 1, 1107 }, { 4, 0, 0, -1, 1021 }, { 4, 0, -1, 1, 833 },
+        { 0, 0, 1, -3, 777 }, { 4, 0, -2, 1, 671 }, { 2, 0, 0, -3, 607 },
+        { 2, 0, 2, -1, 596 }, { 2, -1, 1, -1, 491 }, { 2, 0, -2, 1, -451 },
+        { 0, 0, 3, -1, 439 }, { 2, 0, 2, 1, 422 }, { 2, 0, -3, -1, 421 },
+        { 2, 1, -1, 1, -366 }, { 2, 1, 0, 1, -351 }, { 4, 0, 0, 1, 331 },
+        { 2, -1, 1, 1, 315 }, { 2, -2, 0, -1, 302 }, { 0, 0, 1, 3, -283 },
+        { 2, 1, 1, -1, -229 }, { 1, 1, 0, -1, 223 }, { 1, 1, 0, 1, 223 },
+        { 0, 1, -2, -1, -220 }, { 2, 1, -1, -1, -220 }, { 1, 0, 1, 1, -185 },
+        { 2, -1, -2, -1, 181 }, { 0, 1, 2, 1, -177 }, { 4, 0, -2, -1, 176 },
+        { 4, -1, -1, -1, 166 }, { 1, 0, 1, -1, -164 }, { 4, 0, 1, -1, 132 },
+        { 1, 0, -1, -1, -119 }, { 4, -1, 0, -1, 115 }, { 2, -2, 0, 1, 107 }
+    };
+
+    constexpr size_t moonLRCount = sizeof(moonLR) / sizeof(moonLR[0]);
+    constexpr size_t moonBCount = sizeof(moonB) / sizeof(moonB[0]);
+    constexpr size_t moonLowLRCount = 30;   // |l| >= 0.0023 degrees
+    constexpr size_t moonLowBCount = 20;    // |b| >= 0.0018 degrees
+
+    //========================================================================
+    // Nutation, IAU 1980 theory (Meeus table 22.A): multiples of D, M, M', F, Omega and the
+    // coefficients in 0.0001 arc seconds (constant + T term).
+
+    typedef struct {
+        int8_t D, M, Mp, F, Om;
+        float psi, psiT;
+        float eps, epsT;
+    } NutationTerm;
+
+    const NutationTerm nutation[] = {
+        { 0, 0, 0, 0, 1, -171996, -174.2f, 92025, 8.9f }, { -2, 0, 0, 2, 2, -13187, -1.6f, 5736, -3.1f },
+        { 0, 0, 0, 2, 2, -2274, -0.2f, 977, -0.5f }, { 0, 0, 0, 0, 2, 2062, 0.2f, -895, 0.5f },
+        { 0, 1, 0, 0, 0, 1426, -3.4f, 54, -0.1f }, { 0, 0, 1, 0, 0, 712, 0.1f, -7, 0 },
+        { -2, 1, 0, 2, 2, -517, 1.2f, 224, -0.6f }, { 0, 0, 0, 2, 1, -386, -0.4f, 200, 0 },
+        { 0, 0, 1, 2, 2, -301, 0, 129, -0.1f }, { -2, -1, 0, 2, 2, 217, -0.5f, -95, 0.3f },
+        { -2, 0, 1, 0, 0, -158, 0, 0, 0 }, { -2, 0, 0, 2, 1, 129, 0.1f, -70, 0 },
+        { 0, 0, -1, 2, 2, 123, 0, -53, 0 }, { 2, 0, 0, 0, 0, 63, 0, 0, 0 },
+        { 0, 0, 1, 0, 1, 63, 0.1f, -33, 0 }, { 2, 0, -1, 2, 2, -59, 0, 26, 0 },
+        { 0, 0, -1, 0, 1, -58, -0.1f, 32, 0 }, { 0, 0, 1, 2, 1, -51, 0, 27, 0 },
+        { -2, 0, 2, 0, 0, 48, 0, 0, 0 }, { 0, 0, -2, 2, 1, 46, 0, -24, 0 },
+        { 2, 0, 0, 2, 2, -38, 0, 16, 0 }, { 0, 0, 2, 2, 2, -31, 0, 13, 0 },
+        { 0, 0, 2, 0, 0, 29, 0, 0, 0 }, { -2, 0, 1, 2, 2, 29, 0, -12, 0 },
+        { 0, 0, 0, 2, 0, 26, 0, 0, 0 }, { -2, 0, 0, 2, 0, -22, 0, 0, 0 },
+        { 0, 0, -1, 2, 1, 21, 0, -10, 0 }, { 0, 2, 0, 0, 0, 17, -0.1f, 0, 0 },
+        { 2, 0, -1, 0, 1, 16, 0, -8, 0 }, { -2, 2, 0, 2, 2, -16, 0.1f, 7, 0 },
+        { 0, 1, 0, 0, 1, -15, 0, 9, 0 }, { -2, 0, 1, 0, 1, -13, 0, 7, 0 },
+        { 0, -1, 0, 0, 1, -12, 0, 6, 0 }, { 0, 0, 2, -2, 0, 11, 0, 0, 0 },
+        { 2, 0, -1, 2, 1, -10, 0, 5, 0 }, { 2, 0, 1, 2, 2, -8, 0, 3, 0 },
+        { 0, 1, 0, 2, 2, 7, 0, -3, 0 }, { -2, 1, 1, 0, 0, -7, 0, 0, 0 },
+        { 0, -1, 0, 2, 2, -7, 0, 3, 0 }, { 2, 0, 0, 2, 1, -7, 0, 3, 0 },
+        { 2, 0, 1, 0, 0, 6, 0, 0, 0 }, { -2, 0, 2, 2, 2, 6, 0, -3, 0 },
+        { -2, 0, 1, 2, 1, 6, 0, -3, 0 }, { 2, 0, -2, 0, 1, -6, 0, 3, 0 },
+        { 2, 0, 0, 0, 1, -6, 0, 3, 0 }, { 0, -1, 1, 0, 0, 5, 0, 0, 0 },
+        { -2, -1, 0, 2, 1, -5, 0, 3, 0 }, { -2, 0, 0, 0, 1, -5, 0, 3, 0 },
+        { 0, 0, 2, 2, 1, -5, 0, 3, 0 }, { -2, 0, 2, 0, 1, 4, 0, 0, 0 },
+        { -2, 1, 0, 2, 1, 4, 0, 0, 0 }, { 0, 0, 1, -2, 0, 4, 0, 0, 0 },
+        { -1, 0, 1, 0, 0, -4, 0, 0, 0 }, { -2, 1, 0, 0, 0, -4, 0, 0, 0 },
+        { 1, 0, 0, 0, 0, -4, 0, 0, 0 }, { 0, 0, 1, 2, 0, 3, 0, 0, 0 },
+        { 0, 0, -2, 2, 2, -3, 0, 0, 0 }, { -1, -1, 1, 0, 0, -3, 0, 0, 0 },
+        { 0, 1, 1, 0, 0, -3, 0, 0, 0 }, { 0, -1, 1, 2, 2, -3, 0, 0, 0 },
+        { 2, -1, -1, 2, 2, -3, 0, 0, 0 }, { 0, 0, 3, 2, 2, -3, 0, 0, 0 },
+        { 2, -1, 0, 2, 2, -3, 0, 0, 0 }
+    };
+
+    // cos / sin of k * a for k in [lo, hi], by rotation instead of a sin / cos per multiple
+    typedef struct {
+        double c;
+        double s;
+    } Rotation;
+
+    inline Rotation rotate( const Rotation & a, const Rotation & b ) {
+        Rotation r = { a.c * b.c - a.s * b.s, a.s * b.c + a.c * b.s };
+        return r;
+    }
+
+    template<int lo, int hi>
+    struct Multiples {
+        Rotation v[hi - lo + 1];
+        explicit Multiples( double a ) {
+            Rotation one = { std::cos(a), std::sin(a) };
+            Rotation r = { 1, 0 };
+            v[-lo] = r;
+            for(int k = 1; k <= hi || -k >= lo; k++) {
+                r = rotate(r, one);
+                if(k <= hi) v[k - lo] = r;
+                if(-k >= lo) { v[-k - lo].c = r.c; v[-k - lo].s = -r.s; }
+            }
+        }
+        const Rotation & operator[]( int k ) const { return v[k - lo]; }
+    };
+
+    inline double centuries( double JDE ) {
+        return (JDE - J2000) / 36525;
+    }
+
+    // Equatorial from ecliptic coordinates for obliquity eps.
+    inline void eclipticToEquatorial( double lon, double lat, double eps, double & ra, double & dec ) {
+        double sinl = std::sin(lon);
+        ra = std::atan2(sinl * std::cos(eps) - std::tan(lat) * std::sin(eps), std::cos(lon));
+        dec = std::asin(std::sin(lat) * std::cos(eps) + std::cos(lat) * std::sin(eps) * sinl);
+    }
+
+    // Topocentric hour angle / declination at the observer's elevation (Meeus ch. 11, 40), from
+    // the geocentric ones.
+    inline void topocentric( double H, double dec, const SunCalcObserver & o, double sinParallax, double & Htopo, double & decTopo ) {
+        const double ba = 0.99664719; // polar / equatorial radius
+        const double a = 6378140;     // equatorial radius, m
+        double u = std::atan(ba * o.tanPhi);
+        double rhoSin = ba * std::sin(u) + o.elevation / a * o.sinPhi;
+        double rhoCos = std::cos(u) + o.elevation / a * o.cosPhi;
+        double cosDec = std::cos(dec);
+        double den = cosDec - rhoCos * sinParallax * std::cos(H);
+        double dra = std::atan2(-rhoCos * sinParallax * std::sin(H), den);
+        Htopo = H - dra;
+        decTopo = std::atan2((std::sin(dec) - rhoSin * sinParallax) * std::cos(dra), den);
+    }
+
+    SunCalcApparentPosition sunFast( double J ) {
+        double M = getSolarMeanAnomaly(J);
+        double L = getEclipticLongitude(M, getEquationOfCenter(M));
+        SunCalcApparentPosition p;
+        p.rightAscension = getRightAscension(L);
+        p.declination = getSunDeclination(L);
+        p.longitude = L;
+        p.latitude = 0;
+        p.distance = 1.00014 - 0.01671 * std::cos(M) - 0.00014 * std::cos(2 * M);
+        p.obliquity = e;
+        p.siderealOffset = 0;
+        return p;
+    }
+
+    // Meeus ch. 25 low precision, nutation and aberration folded into the longitude.
+    SunCalcApparentPosition sunLow( double JDE ) {
+        double T = centuries(JDE);
+        double L0 = 280.46646 + 36000.76983 * T + 0.0003032 * T * T;
+        double M = degrees(357.52911 + 35999.05029 * T - 0.0001537 * T * T);
+        double ecc = 0.016708634 - 0.000042037 * T - 0.0000001267 * T * T;
+        double C = (1.914602 - 0.004817 * T - 0.000014 * T * T) * std::sin(M)
+                 + (0.019993 - 0.000101 * T) * std::sin(2 * M)
+                 + 0.000289 * std::sin(3 * M);
+        double v = M + C * deg2rad;
+        double omega = degrees(125.04 - 1934.136 * T);
+
+        SunCalcApparentPosition p;
+        p.longitude = degrees(L0 + C - 0.00569 - 0.00478 * std::sin(omega));
+        p.latitude = 0;
+        p.distance = 1.000001018 * (1 - ecc * ecc) / (1 + ecc * std::cos(v));
+        p.obliquity = getMeanObliquity(JDE) + 0.00256 * deg2rad * std::cos(omega);
+
+        double dpsi, deps;
+        getNutation(JDE, SUNCALC_ACCURACY_LOW, dpsi, deps);
+        p.siderealOffset = dpsi * std::cos(p.obliquity);
+
+        eclipticToEquatorial(p.longitude, 0, p.obliquity, p.rightAscension, p.declination);
+        return p;
+    }
+
+    // Meeus ch. 25 higher accuracy: VSOP87, FK5, nutation, aberration.
+    SunCalcApparentPosition sunHigh( double JDE ) {
+        double T = centuries(JDE);
+        double tau = T / 10;
+
+        double L = (vsopSum(L0, tau) + tau * (vsopSum(L1, tau) + tau * (vsopSum(L2, tau) + tau * (vsopSum(L3, tau)
+                   + tau * (vsopSum(L4, tau) + tau * vsopSum(L5, tau)))))) * 1e-8;
+        double B = (vsopSum(B0, tau) + tau * vsopSum(B1, tau)) * 1e-8;
+        double R = (vsopSum(R0, tau) + tau * (vsopSum(R1, tau) + tau * (vsopSum(R2, tau) + tau * (vsopSum(R3, tau)
+                   + tau * vsopSum(R4, tau))))) * 1e-8;
+
+        // geocentric, then to the FK5 system
+        double lon = L + pi;
+        double lat = -B;
+        double lonp = lon - (1.397 * T + 0.00031 * T * T) * deg2rad;
+        lon += -0.09033 * arcsec2rad;
+        lat += 0.03916 * arcsec2rad * (std::cos(lonp) - std::sin(lonp));
+
+        double dpsi, deps;
+        getNutation(JDE, SUNCALC_ACCURACY_HIGH, dpsi, deps);
+
+        SunCalcApparentPosition p;
+        p.longitude = std::remainder(lon + dpsi - 20.4898 * arcsec2rad / R, 2 * pi);
+        p.latitude = lat;
+        p.distance = R;
+        p.obliquity = getMeanObliquity(JDE) + deps;
+        p.siderealOffset = dpsi * std::cos(p.obliquity);
+        eclipticToEquatorial(p.longitude, p.latitude, p.obliquity, p.rightAscension, p.declination);
+        return p;
+    }
+
+    SunCalcApparentPosition moonFast( double J ) {
+        double d = J - J2000;
+        double L = deg2rad * (218.316 + 13.176396 * d);
+        double M = deg2rad * (134.963 + 13.064993 * d);
+        double F = deg2rad * (93.272 + 13.229350 * d);
+
+        SunCalcApparentPosition p;
+        p.longitude = L + deg2rad * 6.289 * std::sin(M);
+        p.latitude = deg2rad * 5.128 * std::sin(F);
+        p.distance = 385001 - 20905 * std::cos(M);
+        p.obliquity = e;
+        p.siderealOffset = 0;
+        p.rightAscension = rightAscension(p.longitude, p.latitude);
+        p.declination = declination(p.longitude, p.latitude);
+        return p;
+    }
+
+    // Meeus ch. 47, the first lrCount / bCount terms of tables 47.A / 47.B.
+    SunCalcApparentPosition moonSeries( double JDE, SunCalcAccuracy accuracy, size_t lrCount, size_t bCount ) {
+        double T = centuries(JDE);
+        double T2 = T * T, T3 = T2 * T, T4 = T3 * T;
+        double Lp = degrees(218.3164477 + 481267.88123421 * T - 0.0015786 * T2 + T3 / 538841 - T4 / 65194000);
+        double D = degrees(297.8501921 + 445267.1114034 * T - 0.0018819 * T2 + T3 / 545868 - T4 / 113065000);
+        double M = degrees(357.5291092 + 35999.0502909 * T - 0.0001536 * T2 + T3 / 24490000);
+        double Mp = degrees(134.9633964 + 477198.8675055 * T + 0.0087414 * T2 + T3 / 69699 - T4 / 14712000);
+        double F = degrees(93.2720950 + 483202.0175233 * T - 0.0036539 * T2 - T3 / 3526000 + T4 / 863310000);
+        double A1 = degrees(119.75 + 131.849 * T);
+        double A2 = degrees(53.09 + 479264.290 * T);
+        double A3 = degrees(313.45 + 481266.484 * T);
+        double E = 1 - 0.002516 * T - 0.0000074 * T2;
+        const double Ef[3] = { 1, E, E * E };
+
+        // every term's argument is a small multiple combination, so its sin / cos are
+        // products of precomputed multiples rather than a sin / cos per term
+        Multiples<0, 4> Dk(D);
+        Multiples<-2, 2> Mk(M);
+        Multiples<-4, 4> Mpk(Mp);
+        Multiples<-3, 3> Fk(F);
+
+        double sl = 0, sr = 0, sb = 0;
+        for(size_t i = 0; i < lrCount; i++) {
+            const MoonTermLR & t = moonLR[i];
+            Rotation arg = rotate(rotate(Dk[t.D], Mk[t.M]), rotate(Mpk[t.Mp], Fk[t.F]));
+            double f = Ef[t.M < 0 ? -t.M : t.M];
+            sl += f * t.l * arg.s;
+            sr += f * t.r * arg.c;
+        }
+        for(size_t i = 0; i < bCount; i++) {
+            const MoonTermB & t = moonB[i];
+            Rotation arg = rotate(rotate(Dk[t.D], Mk[t.M]), rotate(Mpk[t.Mp], Fk[t.F]));
+            sb += Ef[t.M < 0 ? -t.M : t.M] * t.b * arg.s;
+        }
+        sl += 3958 * std::sin(A1) + 1962 * std::sin(Lp - F) + 318 * std::sin(A2);
+        sb += -2235 * std::sin(Lp) + 382 * std::sin(A3) + 175 * std::sin(A1 - F) + 175 * std::sin(A1 + F)
+            + 127 * std::sin(Lp - Mp) - 115 * std::sin(Lp + Mp);
+
+        double dpsi, deps;
+        getNutation(JDE, accuracy, dpsi, deps);
+
+        SunCalcApparentPosition p;
+        p.longitude = std::remainder(Lp + sl * 1e-6 * deg2rad + dpsi, 2 * pi);
+        p.latitude = sb * 1e-6 * deg2rad;
+        p.distance = 385000.56 + sr / 1000;
+        p.obliquity = getMeanObliquity(JDE) + deps;
+        p.siderealOffset = dpsi * std::cos(p.obliquity);
+        eclipticToEquatorial(p.longitude, p.latitude, p.obliquity, p.rightAscension, p.declination);
+        return p;
+    }
+
+    // Horizontal coordinates at UT J for an apparent place, with parallax.
+    void toHorizontal( double J, const SunCalcObserver & o, const SunCalcApparentPosition & p, double sinParallax, double & azimuth, double & altitude, double & H, double & dec ) {
+        double theta = getGreenwichSiderealTime(J) + p.siderealOffset;
+        topocentric(theta - o.lw - p.rightAscension, p.declination, o, sinParallax, H, dec);
+        azimuth = std::atan2(std::sin(H), std::cos(H) * o.sinPhi - std::tan(dec) * o.cosPhi);
+        altitude = std::asin(o.sinPhi * std::sin(dec) + o.cosPhi * std::cos(dec) * std::cos(H));
+    }
+
+    SunCalcObserver toObserver( double lw, double phi ) {
+        return getObserver(phi / deg2rad, -lw / deg2rad);
+    }
+
+}
+
+namespace ofxSunCalcCore {
+
+    double getDeltaT( double J ) {
+        // Espenak & Meeus polynomials (NASA eclipse web site), long term parabola outside 1800 - 2150
+        double y = 2000 + (J - J2000) / 365.25;
+        double t;
+        if(y < 1800 || y >= 2150) {
+            double u = (y - 1820) / 100;
+            return -20 + 32 * u * u;
+        }
+        if(y < 1860) {
+            t = y - 1800;
+            return 13.72 - 0.332447 * t + 0.0068612 * t * t + 0.0041116 * t * t * t - 0.00037436 * std::pow(t, 4)
+                 + 0.0000121272 * std::pow(t, 5) - 0.0000001699 * std::pow(t, 6) + 0.000000000875 * std::pow(t, 7);
+        }
+        if(y < 1900) {
+            t = y - 1860;
+            return 7.62 + 0.5737 * t - 0.251754 * t * t + 0.01680668 * t * t * t - 0.0004473624 * std::pow(t, 4) + std::pow(t, 5) / 233174;
+        }
+        if(y < 1920) {
+            t = y - 1900;
+            return -2.79 + 1.494119 * t - 0.0598939 * t * t + 0.0061966 * t * t * t - 0.000197 * std::pow(t, 4);
+        }
+        if(y < 1941) {
+            t = y - 1920;
+            return 21.20 + 0.84493 * t - 0.076100 * t * t + 0.0020936 * t * t * t;
+        }
+        if(y < 1961) {
+            t = y - 1950;
+            return 29.07 + 0.407 * t - t * t / 233 + t * t * t / 2547;
+        }
+        if(y < 1986) {
+            t = y - 1975;
+            return 45.45 + 1.067 * t - t * t / 260 - t * t * t / 718;
+        }
+        if(y < 2005) {
+            t = y - 2000;
+            return 63.86 + 0.3345 * t - 0.060374 * t * t + 0.0017275 * t * t * t + 0.000651814 * std::pow(t, 4) + 0.00002373599 * std::pow(t, 5);
+        }
+        if(y < 2050) {
+            t = y - 2000;
+            return 62.92 + 0.32217 * t + 0.005589 * t * t;
+        }
+        double u = (y - 1820) / 100;
+        return -20 + 32 * u * u - 0.5628 * (2150 - y);
+    }
+
+    double getMeanObliquity( double JDE ) {
+        // Meeus 22.2
+        double T = centuries(JDE);
+        return (23.0 + 26.0 / 60 + (21.448 - 46.8150 * T - 0.00059 * T * T + 0.001813 * T * T * T) / 3600) * deg2rad;
+    }
+
+    void getNutation( double JDE, SunCalcAccuracy accuracy, double & longitude, double & obliquity ) {
+        double T = centuries(JDE);
+        double T2 = T * T, T3 = T2 * T;
+        double omega = degrees(125.04452 - 1934.136261 * T + 0.0020708 * T2 + T3 / 450000);
+
+        if(accuracy == SUNCALC_ACCURACY_FAST) {
+            longitude = obliquity = 0;
+        }else if(accuracy == SUNCALC_ACCURACY_LOW) {
+            // Meeus ch. 22, 0.5" / 0.1"
+            double L = degrees(280.4665 + 36000.7698 * T);
+            double Lp = degrees(218.3165 + 481267.8813 * T);
+            longitude = (-17.20 * std::sin(omega) - 1.32 * std::sin(2 * L) - 0.23 * std::sin(2 * Lp) + 0.21 * std::sin(2 * omega)) * arcsec2rad;
+            obliquity = (9.20 * std::cos(omega) + 0.57 * std::cos(2 * L) + 0.10 * std::cos(2 * Lp) - 0.09 * std::cos(2 * omega)) * arcsec2rad;
+        }else{
+            double D = degrees(297.85036 + 445267.111480 * T - 0.0019142 * T2 + T3 / 189474);
+            double M = degrees(357.52772 + 35999.050340 * T - 0.0001603 * T2 - T3 / 300000);
+            double Mp = degrees(134.96298 + 477198.867398 * T + 0.0086972 * T2 + T3 / 56250);
+            double F = degrees(93.27191 + 483202.017538 * T - 0.0036825 * T2 + T3 / 327270);
+            Multiples<-2, 2> Dk(D);
+            Multiples<-2, 2> Mk(M);
+            Multiples<-2, 3> Mpk(Mp);
+            Multiples<-2, 2> Fk(F);
+            Multiples<0, 2> Omk(omega);
+            double psi = 0, eps = 0;
+            for(const NutationTerm & t : nutation) {
+                Rotation arg = rotate(rotate(rotate(Dk[t.D], Mk[t.M]), rotate(Mpk[t.Mp], Fk[t.F])), Omk[t.Om]);
+                psi += (t.psi + t.psiT * T) * arg.s;
+                eps += (t.eps + t.epsT * T) * arg.c;
+            }
+            longitude = psi * 0.0001 * arcsec2rad;
+            obliquity = eps * 0.0001 * arcsec2rad;
+        }
+    }
+
+    double getGreenwichSiderealTime( double J ) {
+        // Meeus 12.4, the day count split off so it keeps its precision
+        double d = J - J2000;
+        double T = d / 36525;
+        double days = std::floor(d);
+        double theta = 280.46061837 + 360.98564736629 * (d - days) + std::fmod(0.98564736629 * days, 360.0)
+                     + 0.000387933 * T * T - T * T * T / 38710000;
+        return degrees(theta);
+    }
+
+    SunCalcApparentPosition getSunApparentPosition( double JDE, SunCalcAccuracy accuracy ) {
+        switch(accuracy) {
+            case SUNCALC_ACCURACY_FAST: return sunFast(JDE);
+            case SUNCALC_ACCURACY_LOW: return sunLow(JDE);
+            default: return sunHigh(JDE);
+        }
+    }
+
+    SunCalcApparentPosition getMoonApparentPosition( double JDE, SunCalcAccuracy accuracy ) {
+        switch(accuracy) {
+            case SUNCALC_ACCURACY_FAST: return moonFast(JDE);
+            case SUNCALC_ACCURACY_LOW: return moonSeries(JDE, accuracy, moonLowLRCount, moonLowBCount);
+            default: return moonSeries(JDE, accuracy, moonLRCount, moonBCount);
+        }
+    }
+
+    SunCalcPosition getSunPosition( double J, const SunCalcObserver & observer, SunCalcAccuracy accuracy ) {
+        if(accuracy == SUNCALC_ACCURACY_FAST) return getSunPosition(J, observer);
+
+        double JDE = J + getDeltaT(J) / 86400;
+        SunCalcApparentPosition p = getSunApparentPosition(JDE, accuracy);
+        SunCalcPosition pos;
+        double H, dec;
+        toHorizontal(J, observer, p, std::sin(8.794 * arcsec2rad) / p.distance, pos.azimuth, pos.altitude, H, dec);
+        return pos;
+    }
+
+    MoonCalcPosition getMoonPosition( double J, const SunCalcObserver & observer, SunCalcAccuracy accuracy ) {
+        if(accuracy == SUNCALC_ACCURACY_FAST) return getMoonPosition(J, observer);
+
+        double JDE = J + getDeltaT(J) / 86400;
+        SunCalcApparentPosition p = getMoonApparentPosition(JDE, accuracy);
+        MoonCalcPosition mp;
+        double H, dec;
+        toHorizontal(J, observer, p, 6378.14 / p.distance, mp.azimuth, mp.altitude, H, dec);
+        mp.altitude += observer.refraction * astroRefraction(mp.altitude);
+        mp.distance = p.distance;
+        mp.parallacticAngle = std::atan2(std::sin(H), observer.tanPhi * std::cos(dec) - std::sin(dec) * std::cos(H));
+        return mp;
+    }
+
+    SunCalcPosition getSunPosition( double J, double lw, double phi, SunCalcAccuracy accuracy ) {
+        if(accuracy == SUNCALC_ACCURACY_FAST) return getSunPosition(J, lw, phi);
+        return getSunPosition(J, toObserver(lw, phi), accuracy);
+    }
+
+    MoonCalcPosition getMoonPosition( double J, double lw, double phi, SunCalcAccuracy accuracy ) {
+        if(accuracy == SUNCALC_ACCURACY_FAST) return getMoonPosition(J, lw, phi);
+        return getMoonPosition(J, toObserver(lw, phi), accuracy);
+    }
+
+}
@@ -0,0 +1,79 @@
+//
+//  ofxSunCalcAccuracy.h
+//
+//  Sun / moon positions at selectable cost / accuracy tiers, from the suncalc model used
+//  everywhere else in ofxSunCalc up to arc second level series. All follow "Astronomical
+//  Algorithms" 2nd edition by Jean Meeus (Willmann-Bell, Richmond) 1998:
+//
+//      tier    sun                                 moon                                  ~cost
+//      FAST    suncalc model, fixed obliquity,     suncalc model (one term series),      1x
+//              no precession: ~1 arc minute        ~0.5 degree (no parallax)
+//              around 2000, off by ~50"/year
+//              away from it (~1.2 deg by 1900)
+//      LOW     ch. 25 low precision, ~0.01 deg     largest ch. 47 terms (30 lon / dist,  sun 3x
+//              4 term nutation                     20 lat), ~0.02 deg, 4 term nutation   moon 5x
+//      HIGH    truncated VSOP87 earth (Meeus       all ch. 47 (ELP-2000/82) terms,       sun 18x
+//              app. III), FK5, ~1 arc second       ~10 arc seconds, 63 term nutation     moon 9x
+//
+//  LOW and HIGH include Delta T (TT - UT, Espenak / Meeus polynomials), nutation, the true
+//  obliquity, aberration, the apparent sidereal time and topocentric parallax (IAU ellipsoid,
+//  at sea level unless given a SunCalcObserver with an elevation). As in the FAST model the
+//  sun altitude is geometric and the moon altitude includes astroRefraction. J is taken as UT1;
+//  UTC (eg. from Poco) is within 0.9 s of it, which is up to 14 arc seconds of hour angle, so
+//  pass UT1 when arc seconds matter.
+//
+//  Coefficients are in flat arrays of small PODs (ofxSunCalcAccuracy.cpp), each series is
+//  summed in one linear pass, periodic terms from precomputed multiples of their fundamental
+//  arguments (no sin / cos per term). Checked against Meeus examples 12.a, 22.a, 25.a, 25.b and 47.a.
+//
+//  No openFrameworks / Poco dependency.
+//
+
+#ifndef __ofxSunCalcAccuracy__
+#define __ofxSunCalcAccuracy__
+
+#include "ofxSunCalcCore.h"
+
+enum SunCalcAccuracy {
+    SUNCALC_ACCURACY_FAST,
+    SUNCALC_ACCURACY_LOW,
+    SUNCALC_ACCURACY_HIGH
+};
+
+// Apparent geocentric place, equinox of date, radians.
+typedef struct {
+    double rightAscension;
+    double declination;
+    double longitude;       // ecliptic
+    double latitude;
+    double distance;        // sun in AU, moon in km
+    double obliquity;       // true obliquity used
+    double siderealOffset;  // equation of the equinoxes (nutation in right ascension)
+} SunCalcApparentPosition;
+
+namespace ofxSunCalcCore {
+
+    // TT - UT in seconds at Julian date J.
+    double getDeltaT( double J );
+
+    // JDE is a dynamical time (TT) Julian date.
+    double getMeanObliquity( double JDE );
+    void getNutation( double JDE, SunCalcAccuracy accuracy, double & longitude, double & obliquity );
+
+    // Greenwich mean sidereal time at UT Julian date J (Meeus 12.4), radians.
+    double getGreenwichSiderealTime( double J );
+
+    SunCalcApparentPosition getSunApparentPosition( double JDE, SunCalcAccuracy accuracy );
+    SunCalcApparentPosition getMoonApparentPosition( double JDE, SunCalcAccuracy accuracy );
+
+    // As getSunPosition / getMoonPosition( J, lw, phi ) at the given tier, J in UT.
+    SunCalcPosition getSunPosition( double J, double lw, double phi, SunCalcAccuracy accuracy );
+    MoonCalcPosition getMoonPosition( double J, double lw, double phi, SunCalcAccuracy accuracy );
+
+    // LOW / HIGH take the parallax at the observer's elevation and scale the moon's refraction.
+    SunCalcPosition getSunPosition( double J, const SunCalcObserver & observer, SunCalcAccuracy accuracy );
+    MoonCalcPosition getMoonPosition( double J, const SunCalcObserver & observer, SunCalcAccuracy accuracy );
+
+}
+
+#endif /* defined(__ofxSunCalcAccuracy__) */
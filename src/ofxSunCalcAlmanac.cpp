@@ -0,0 +1,214 @@
+#include "ofxSunCalcAlmanac.h"
+#include "ofxSunCalcGrid.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+    const char almanacMagic[8] = { 'S', 'C', 'A', 'L', 'M', 'N', 'C', 0 };
+    
+    static_assert(sizeof(ofxSunCalcAlmanac::Header) == 64, "almanac header layout changed");
+
+    void packRecord( const SunCalcDayTimes & t, double * out ) {
+        out[0] = t.nightEnd;
+        out[1] = t.nauticalDawn;
+        out[2] = t.dawn;
+        out[3] = t.sunriseStart;
+        out[4] = t.sunriseEnd;
+        out[5] = t.transit;
+        out[6] = t.sunsetStart;
+        out[7] = t.sunsetEnd;
+        out[8] = t.dusk;
+        out[9] = t.nauticalDusk;
+        out[10] = t.nightStart;
+        out[ofxSunCalcAlmanac::fieldFlags] = (t.polarDay ? ofxSunCalcAlmanac::recordPolarDay : 0)
+                                           | (t.polarNight ? ofxSunCalcAlmanac::recordPolarNight : 0);
+    }
+
+}
+
+bool ofxSunCalcAlmanac::write( const std::string & path, const std::vector<SunCalcSite> & sites, double startJ, int numDays,
+                               bool detailed, unsigned numThreads, size_t blockSites ) {
+    if(numDays < 0) numDays = 0;
+    if(blockSites == 0) blockSites = 1;
+
+    Header h;
+    memset(&h, 0, sizeof(h));
+    memcpy(h.magic, almanacMagic, sizeof(h.magic));
+    h.version = version;
+    h.byteOrder = byteOrderMark;
+    h.headerSize = sizeof(Header);
+    h.recordSize = fieldsPerRecord * sizeof(double);
+    h.flags = detailed ? flagDetailed : 0;
+    h.numDays = numDays;
+    h.numSites = sites.size();
+    h.startJ = startJ;
+    h.sitesOffset = sizeof(Header);
+    h.recordsOffset = h.sitesOffset + sites.size() * 2 * sizeof(double);
+
+    FILE * f = fopen(path.c_str(), "wb");
+    if(!f) return false;
+
+    bool ok = fwrite(&h, sizeof(h), 1, f) == 1;
+
+    for(size_t i = 0; ok && i < sites.size(); i++) {
+        double latlon[2] = { sites[i].lat, sites[i].lon };
+        ok = fwrite(latlon, sizeof(latlon), 1, f) == 1;
+    }
+
+    // stream the records a block of sites at a time
+    std::vector<SunCalcDayTimes> times;
+    std::vector<double> records;
+    for(size_t first = 0; ok && first < sites.size() && numDays > 0; first += blockSites) {
+        size_t count = std::min(blockSites, sites.size() - first);
+        times.resize(count * numDays);
+        ofxSunCalcGrid::getDayTimes( sites.data() + first, count, startJ, numDays, detailed, times.data(), numThreads );
+
+        records.resize(times.size() * fieldsPerRecord);
+        for(size_t i = 0; i < times.size(); i++) {
+            packRecord(times[i], &records[i * fieldsPerRecord]);
+        }
+        ok = fwrite(records.data(), sizeof(double), records.size(), f) == records.size();
+    }
+
+    ok = fclose(f) == 0 && ok;
+    if(!ok) remove(path.c_str());
+    return ok;
+}
+
+ofxSunCalcAlmanac::ofxSunCalcAlmanac() : data(nullptr), size(0) {
+#ifdef _WIN32
+    file = INVALID_HANDLE_VALUE;
+    mapping = nullptr;
+#endif
+}
+
+ofxSunCalcAlmanac::~ofxSunCalcAlmanac() {
+    close();
+}
+
+bool ofxSunCalcAlmanac::open( const std::string & path ) {
+    close();
+
+#ifdef _WIN32
+    file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if(file == INVALID_HANDLE_VALUE) return false;
+    LARGE_INTEGER fileSize;
+    if(!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart < (LONGLONG)sizeof(Header)) {
+        close();
+        return false;
+    }
+    size = (size_t)fileSize.QuadPart;
+    mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if(!mapping) {
+        close();
+        return false;
+    }
+    data = (const unsigned char *)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if(!data) {
+        close();
+        return false;
+    }
+#else
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if(fd < 0) return false;
+    struct stat st;
+    if(fstat(fd, &st) != 0 || st.st_size < (off_t)sizeof(Header)) {
+        ::close(fd);
+        return false;
+    }
+    size = (size_t)st.st_size;
+    void * p = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd); // the mapping keeps the file referenced
+    if(p == MAP_FAILED) {
+        size = 0;
+        return false;
+    }
+    data = (const unsigned char *)p;
+#endif
+
+    const Header & h = getHeader();
+    // sizes are bounded by division before any multiply, so a corrupt count can't wrap the checks
+    bool valid = memcmp(h.magic, almanacMagic, sizeof(h.magic)) == 0
+        && h.version == version
+        && h.byteOrder == byteOrderMark
+        && h.headerSize == sizeof(Header)
+        && h.recordSize == fieldsPerRecord * sizeof(double)
+        && h.sitesOffset >= sizeof(Header)
+        && h.sitesOffset % sizeof(double) == 0
+        && h.sitesOffset <= size
+        && h.numSites <= (size - h.sitesOffset) / (2 * sizeof(double))
+        && h.recordsOffset >= h.sitesOffset + h.numSites * 2 * sizeof(double)
+        && h.recordsOffset % sizeof(double) == 0
+        && h.recordsOffset <= size
+        && (h.numDays == 0 || h.numSites <= (size - h.recordsOffset) / h.recordSize / h.numDays);
+
+    if(!valid) {
+        close();
+        return false;
+    }
+    return true;
+}
+
+void ofxSunCalcAlmanac::close() {
+#ifdef _WIN32
+    if(data) UnmapViewOfFile(data);
+    if(mapping) CloseHandle(mapping);
+    if(file != INVALID_HANDLE_VALUE) CloseHandle(file);
+    mapping = nullptr;
+    file = INVALID_HANDLE_VALUE;
+#else
+    if(data) munmap((void *)data, size);
+#endif
+    data = nullptr;
+    size = 0;
+}
+
+SunCalcSite ofxSunCalcAlmanac::getSite( size_t site ) const {
+    const double * latlon = (const double *)(data + getHeader().sitesOffset) + site * 2;
+    SunCalcSite s;
+    s.lat = latlon[0];
+    s.lon = latlon[1];
+    return s;
+}
+
+int ofxSunCalcAlmanac::getDayIndex( double J ) const {
+    double day = std::floor(J - getStartJulianDate());
+    if(!(day >= 0 && day < getNumDays())) return -1;
+    return (int)day;
+}
+
+SunCalcDayTimes ofxSunCalcAlmanac::getDayTimes( size_t site, int day ) const {
+    const double * r = getRecord(site, day);
+    SunCalcDayTimes t;
+    t.nightEnd = r[0];
+    t.nauticalDawn = r[1];
+    t.dawn = r[2];
+    t.sunriseStart = r[3];
+    t.sunriseEnd = r[4];
+    t.transit = r[5];
+    t.sunsetStart = r[6];
+    t.sunsetEnd = r[7];
+    t.dusk = r[8];
+    t.nauticalDusk = r[9];
+    t.nightStart = r[10];
+    t.detailed = isDetailed();
+
+    uint32_t flags = (uint32_t)r[fieldFlags];
+    t.polarDay = (flags & recordPolarDay) != 0;
+    t.polarNight = (flags & recordPolarNight) != 0;
+    return t;
+}
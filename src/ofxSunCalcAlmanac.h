@@ -0,0 +1,104 @@
+//
+//  ofxSunCalcAlmanac.h
+//
+//  Precomputed day times for a (site x date) grid in a fixed record binary file, written in
+//  bounded blocks and read back through a memory map: any site / day is an offset into the
+//  mapping, nothing is parsed or copied on open.
+//
+//  File layout (version 2, native byte order, all offsets in bytes from the file start):
+//
+//      header      64 bytes, see Header below
+//      sites       numSites x { double lat, double lon } (degrees)
+//      records     numSites x numDays x 12 doubles, site major: the SunCalcDayTimes fields in
+//                  order (nightEnd ... nightStart) as Julian dates, NaN when the event does not
+//                  happen, then the record flags (recordPolarDay | recordPolarNight) as a double
+//
+//  Record of (site, day) = recordsOffset + (site * numDays + day) * recordSize.
+//
+
+#ifndef __ofxSunCalcAlmanac__
+#define __ofxSunCalcAlmanac__
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "ofxSunCalcCore.h"
+
+class ofxSunCalcAlmanac {
+
+public:
+
+    typedef struct {
+        char magic[8];              // "SCALMNC\0"
+        uint32_t version;
+        uint32_t byteOrder;         // byteOrderMark as written, reads back swapped on a foreign endian machine
+        uint32_t headerSize;
+        uint32_t recordSize;
+        uint32_t flags;             // flagDetailed
+        uint32_t numDays;
+        uint64_t numSites;
+        double startJ;              // Julian date of day 0
+        uint64_t sitesOffset;
+        uint64_t recordsOffset;
+    } Header;
+
+    static const uint32_t version = 2;
+    static const uint32_t byteOrderMark = 0x01020304;
+    static const uint32_t flagDetailed = 1;
+    static const uint32_t recordPolarDay = 1;
+    static const uint32_t recordPolarNight = 2;
+    static const size_t fieldFlags = 11;
+    static const size_t fieldsPerRecord = 12;
+
+    // Computes and writes the almanac of sites for numDays days from startJ to path. Day times
+    // are computed (multithreaded, see ofxSunCalcGrid) and written blockSites sites at a time,
+    // so memory stays bounded for any grid size. Returns false if the file can't be written.
+    static bool write( const std::string & path, const std::vector<SunCalcSite> & sites, double startJ, int numDays,
+                       bool detailed = true, unsigned numThreads = 0, size_t blockSites = 64 );
+
+    ofxSunCalcAlmanac();
+    ~ofxSunCalcAlmanac();
+
+    ofxSunCalcAlmanac( const ofxSunCalcAlmanac & ) = delete;
+    ofxSunCalcAlmanac & operator=( const ofxSunCalcAlmanac & ) = delete;
+
+    // Maps the file read only. Returns false (and stays closed) if it is missing, truncated or
+    // not an almanac of this version and machine's byte order.
+    bool open( const std::string & path );
+    void close();
+    bool isOpen() const { return data != nullptr; }
+
+    const Header & getHeader() const { return *(const Header *)data; }
+    size_t getNumSites() const { return (size_t)getHeader().numSites; }
+    int getNumDays() const { return (int)getHeader().numDays; }
+    double getStartJulianDate() const { return getHeader().startJ; }
+    bool isDetailed() const { return (getHeader().flags & flagDetailed) != 0; }
+
+    SunCalcSite getSite( size_t site ) const;
+
+    // Day index of Julian date J, -1 when outside the almanac.
+    int getDayIndex( double J ) const;
+
+    // Zero copy access to the fieldsPerRecord doubles of (site, day), in SunCalcDayTimes order
+    // then the flags at fieldFlags.
+    const double * getRecord( size_t site, int day ) const {
+        const Header & h = getHeader();
+        return (const double *)(data + h.recordsOffset + (site * h.numDays + day) * h.recordSize);
+    }
+
+    SunCalcDayTimes getDayTimes( size_t site, int day ) const;
+
+private:
+
+    const unsigned char * data;
+    size_t size;
+
+#ifdef _WIN32
+    void * file;
+    void * mapping;
+#endif
+
+};
+
+#endif /* defined(__ofxSunCalcAlmanac__) */
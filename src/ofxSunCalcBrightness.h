@@ -0,0 +1,125 @@
+//
+//  ofxSunCalcBrightness.h
+//
+//  Sun altitude driven brightness in [0, 1], and a per site / per day lookup table of it.
+//
+//  The curve is piecewise linear in altitude through the twilight boundaries, with the
+//  levels roughly following log10 of outdoor illuminance (~0.001 lux astronomical night
+//  -> ~700 lux once the sun is fully up), so each phase gets a visible share of the ramp:
+//
+//      altitude        brightness
+//      <= -18          0       night
+//         -12          0.15    astronomical -> nautical twilight
+//          -6          0.6     nautical -> civil twilight
+//          -0.833      0.95    sunrise start / sunset end
+//      >= -0.3         1       day
+//
+//  ofxSunCalcBrightnessTable samples that curve for one site across one day at a configurable
+//  step; lookups are then O(1) with linear interpolation and no trig. The error vs the direct
+//  curve only shows where a sample step straddles one of the knots above: < 0.005 at 1 minute
+//  resolution (the default), < 0.02 at 5 minutes.
+//
+//  Header only, no openFrameworks / Poco dependency.
+//
+
+#ifndef __ofxSunCalcBrightness__
+#define __ofxSunCalcBrightness__
+
+#include <vector>
+
+#include "ofxSunCalcCore.h"
+
+namespace ofxSunCalcCore {
+
+    // altitude in radians
+    inline double getSunBrightness( double altitude ) noexcept {
+        const double h[5] = { h3, h2, h1, h0, h0 + d0 };
+        const double b[5] = { 0, 0.15, 0.6, 0.95, 1 };
+
+        if(altitude <= h[0]) return 0;
+        if(altitude >= h[4]) return 1;
+        int i = 1;
+        while(altitude > h[i]) i++;
+        return b[i - 1] + (b[i] - b[i - 1]) * (altitude - h[i - 1]) / (h[i] - h[i - 1]);
+    }
+
+    inline double getSunBrightness( double J, double lw, double phi ) noexcept {
+        return getSunBrightness(getSunPosition(J, lw, phi).altitude);
+    }
+
+    // The curve follows the observer's horizon dip, as its day events do.
+    inline double getSunBrightness( double J, const SunCalcObserver & o ) noexcept {
+        return getSunBrightness(getSunPosition(J, o).altitude - getHorizonDip(o.elevation));
+    }
+
+}
+
+class ofxSunCalcBrightnessTable {
+
+public:
+
+    ofxSunCalcBrightnessTable() {
+    }
+
+    ofxSunCalcBrightnessTable( double startJ, double lw, double phi, int samplesPerDay = 1440 ) {
+        build(startJ, lw, phi, samplesPerDay);
+    }
+
+    // degrees, as ofxSunCalc
+    ofxSunCalcBrightnessTable( double startJ, const SunCalcSite & site, int samplesPerDay = 1440 )
+    : ofxSunCalcBrightnessTable( startJ, -site.lon * ofxSunCalcCore::deg2rad, site.lat * ofxSunCalcCore::deg2rad, samplesPerDay ) {
+    }
+
+    // One day [startJ, startJ + 1) at samplesPerDay steps (1440 = per minute, 288 = 5 minutes).
+    void build( double startJ, double lw, double phi, int samplesPerDay = 1440 ) {
+        if(samplesPerDay < 1) samplesPerDay = 1;
+        start = startJ;
+        this->lw = lw;
+        this->phi = phi;
+        scale = samplesPerDay;
+
+        // inclusive of the end of the day so lookups interpolate up to startJ + 1
+        values.resize(samplesPerDay + 1);
+        for(int i = 0; i <= samplesPerDay; i++) {
+            values[i] = (float)ofxSunCalcCore::getSunBrightness(start + i / scale, lw, phi);
+        }
+    }
+
+    bool contains( double J ) const noexcept {
+        return !values.empty() && J >= start && J <= start + 1;
+    }
+
+    double getStartJulianDate() const noexcept { return start; }
+    int getSamplesPerDay() const noexcept { return (int)scale; }
+
+    // Interpolated brightness at J, or the direct curve when J is outside the table's day.
+    float getBrightness( double J ) const noexcept {
+        if(!contains(J)) return (float)ofxSunCalcCore::getSunBrightness(J, lw, phi);
+
+        double x = (J - start) * scale;
+        size_t i = (size_t)x;
+        if(i + 1 >= values.size()) i = values.size() - 2;
+        float t = (float)(x - i);
+        return values[i] + (values[i + 1] - values[i]) * t;
+    }
+
+    // Batch lookup, e.g. fixtures on different time offsets.
+    void getBrightness( const double * J, size_t count, float * out ) const noexcept {
+        for(size_t i = 0; i < count; i++) {
+            out[i] = getBrightness(J[i]);
+        }
+    }
+
+    const std::vector<float> & getValues() const noexcept { return values; }
+
+private:
+
+    double start = 0;
+    double lw = 0;
+    double phi = 0;
+    double scale = 1;
+    std::vector<float> values;
+
+};
+
+#endif /* defined(__ofxSunCalcBrightness__) */
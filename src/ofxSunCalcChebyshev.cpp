@@ -0,0 +1,170 @@
+#include "ofxSunCalcChebyshev.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+namespace {
+
+    const char chebyshevMagic[8] = { 'S', 'C', 'C', 'H', 'E', 'B', 'Y', 0 };
+    const uint32_t bodyChannels[ofxSunCalcChebyshev::numBodies] = { 3, 4 };
+
+    static_assert(sizeof(ofxSunCalcChebyshev::Header) == 128, "chebyshev header layout changed");
+    static_assert(sizeof(ofxSunCalcChebyshev::Header) % sizeof(double) == 0, "segments must stay double aligned");
+
+    // Chebyshev interpolant of f over one segment: f sampled at the n Chebyshev nodes, the
+    // coefficients by the discrete cosine transform of the samples. samples is [n][channels].
+    void fitSegment( const double * samples, uint32_t n, uint32_t channels, const double * cosTable, double * out ) {
+        for(uint32_t ch = 0; ch < channels; ch++, out += n) {
+            for(uint32_t j = 0; j < n; j++) {
+                double sum = 0;
+                for(uint32_t k = 0; k < n; k++) {
+                    sum += samples[k * channels + ch] * cosTable[j * n + k];
+                }
+                out[j] = sum * (j == 0 ? 1.0 : 2.0) / n;
+            }
+        }
+    }
+
+}
+
+bool ofxSunCalcChebyshev::build( double startJ, double endJ, double sunSegmentDays, int sunCoefficients, double moonSegmentDays, int moonCoefficients ) {
+    clear();
+
+    const double segmentDays[numBodies] = { sunSegmentDays, moonSegmentDays };
+    const int coefficients[numBodies] = { sunCoefficients, moonCoefficients };
+    if(!(endJ > startJ)) return false;
+    for(int i = 0; i < numBodies; i++) {
+        if(!(segmentDays[i] > 0) || coefficients[i] < 2 || coefficients[i] > (int)maxCoefficients) return false;
+    }
+
+    Header h;
+    memset(&h, 0, sizeof(h));
+    memcpy(h.magic, chebyshevMagic, sizeof(h.magic));
+    h.version = version;
+    h.byteOrder = byteOrderMark;
+    h.headerSize = sizeof(Header);
+    h.bodyCount = numBodies;
+    h.startJ = startJ;
+    h.endJ = endJ;
+
+    uint64_t offset = sizeof(Header);
+    for(int i = 0; i < numBodies; i++) {
+        BodyHeader & b = h.bodies[i];
+        b.segmentDays = segmentDays[i];
+        b.numSegments = (uint32_t)std::ceil((endJ - startJ) / segmentDays[i]);
+        b.numCoefficients = coefficients[i];
+        b.numChannels = bodyChannels[i];
+        b.offset = offset;
+        offset += (uint64_t)b.numSegments * b.numChannels * b.numCoefficients * sizeof(double);
+    }
+    h.size = offset;
+
+    blob.resize(h.size / sizeof(double));
+    memcpy(blob.data(), &h, sizeof(h));
+
+    for(int i = 0; i < numBodies; i++) {
+        const BodyHeader & b = h.bodies[i];
+        uint32_t n = b.numCoefficients;
+
+        double nodes[maxCoefficients];
+        double cosTable[maxCoefficients * maxCoefficients];
+        for(uint32_t k = 0; k < n; k++) {
+            nodes[k] = std::cos(ofxSunCalcCore::pi * (k + 0.5) / n);
+            for(uint32_t j = 0; j < n; j++) {
+                cosTable[j * n + k] = std::cos(ofxSunCalcCore::pi * j * (k + 0.5) / n);
+            }
+        }
+
+        double samples[maxCoefficients * 4];
+        double * out = blob.data() + b.offset / sizeof(double);
+        for(uint32_t s = 0; s < b.numSegments; s++) {
+            double J0 = startJ + s * b.segmentDays;
+            for(uint32_t k = 0; k < n; k++) {
+                double J = J0 + 0.5 * (nodes[k] + 1) * b.segmentDays;
+                if(i == BODY_SUN) directSun(J, samples + k * b.numChannels);
+                else directMoon(J, samples + k * b.numChannels);
+            }
+            fitSegment(samples, n, b.numChannels, cosTable, out);
+            out += b.numChannels * n;
+        }
+    }
+    return true;
+}
+
+bool ofxSunCalcChebyshev::save( const std::string & path ) const {
+    if(!isLoaded()) return false;
+    FILE * f = fopen(path.c_str(), "wb");
+    if(!f) return false;
+    bool ok = fwrite(blob.data(), 1, getBlobSize(), f) == getBlobSize();
+    ok = fclose(f) == 0 && ok;
+    if(!ok) remove(path.c_str());
+    return ok;
+}
+
+bool ofxSunCalcChebyshev::load( const std::string & path ) {
+    clear();
+    FILE * f = fopen(path.c_str(), "rb");
+    if(!f) return false;
+
+    std::vector<double> data;
+    bool ok = fseek(f, 0, SEEK_END) == 0;
+    long size = ok ? ftell(f) : -1;
+    ok = size >= (long)sizeof(Header) && size % sizeof(double) == 0 && fseek(f, 0, SEEK_SET) == 0;
+    if(ok) {
+        data.resize(size / sizeof(double));
+        ok = fread(data.data(), 1, size, f) == (size_t)size;
+    }
+    fclose(f);
+
+    return ok && setBlob(data.data(), data.size() * sizeof(double));
+}
+
+bool ofxSunCalcChebyshev::setBlob( const void * data, size_t size ) {
+    clear();
+    if(!data || size < sizeof(Header) || size % sizeof(double) != 0) return false;
+
+    Header h;
+    memcpy(&h, data, sizeof(h));
+    bool valid = memcmp(h.magic, chebyshevMagic, sizeof(h.magic)) == 0
+        && h.version == version
+        && h.byteOrder == byteOrderMark
+        && h.headerSize == sizeof(Header)
+        && h.bodyCount == numBodies
+        && h.endJ > h.startJ
+        && h.size == size;
+    for(int i = 0; valid && i < numBodies; i++) {
+        const BodyHeader & b = h.bodies[i];
+        // channels and coefficients are bounded first, so bytes fits in 64 bits; the offset is
+        // checked apart so a corrupt one can't wrap the sum
+        valid = b.segmentDays > 0
+            && b.numChannels == bodyChannels[i]
+            && b.numCoefficients >= 2 && b.numCoefficients <= maxCoefficients
+            && b.numSegments >= std::ceil((h.endJ - h.startJ) / b.segmentDays)
+            && b.offset >= sizeof(Header) && b.offset % sizeof(double) == 0
+            && b.offset <= size;
+        uint64_t bytes = valid ? (uint64_t)b.numSegments * b.numChannels * b.numCoefficients * sizeof(double) : 0;
+        valid = valid && bytes <= size - b.offset;
+    }
+    if(!valid) return false;
+
+    blob.resize(size / sizeof(double));
+    memcpy(blob.data(), data, size);
+    return true;
+}
+
+void ofxSunCalcChebyshev::getSunPositions( double J, const double * lw, const double * phi, size_t count, double * azimuth, double * altitude ) const noexcept {
+    double v[3] = { 0, 0, 0 };
+    getSunVector(J, v);
+    double th = ofxSunCalcCore::getSiderealTime(J, 0);
+    for(size_t i = 0; i < count; i++) {
+        double ct = std::cos(th - lw[i]);
+        double st = std::sin(th - lw[i]);
+        double ch = v[0] * ct + v[1] * st;
+        double sh = v[0] * st - v[1] * ct;
+        double sinphi = std::sin(phi[i]);
+        double cosphi = std::cos(phi[i]);
+        azimuth[i] = std::atan2(sh, ch * sinphi - v[2] * cosphi);
+        altitude[i] = std::asin(clampUnit(sinphi * v[2] + cosphi * ch));
+    }
+}
@@ -0,0 +1,247 @@
+//
+//  ofxSunCalcChebyshev.h
+//
+//  Compressed sun / moon ephemeris in the style of JPL SPK files: the location independent
+//  output of the models (getSunDeclination / getRightAscension, getMoonCoords) is fitted by
+//  Chebyshev polynomials over fixed length time segments, and a query is a segment lookup and a
+//  Clenshaw sum per channel. What is fitted is the equatorial unit vector (cos dec cos ra,
+//  cos dec sin ra, sin dec), plus the distance for the moon, so the topocentric conversion
+//  needs only the sine / cosine of the sidereal time and one atan2 / asin, no per query trig
+//  chain through anomaly, ecliptic longitude and obliquity.
+//
+//  build() is the (offline) generator, save() / load() move the coefficient blob to / from a
+//  file, setBlob() takes one already in memory (eg. compiled in). Blob layout (version 1, native
+//  byte order, doubles throughout so it can be held in a double array):
+//
+//      header      Header below, 128 bytes
+//      segments    per body at bodies[i].offset: numSegments x numChannels x numCoefficients
+//                  doubles, segment major then channel, Chebyshev coefficients T0 first
+//
+//  Segment s of a body covers [startJ + s * segmentDays, startJ + (s + 1) * segmentDays).
+//  With the default segments (sun 32 days / 10 coefficients, moon 4 days / 11 coefficients,
+//  about 3.5 MB per century) positions match the direct model to ~1e-9 rad and the moon distance
+//  to ~1e-5 km, a century builds in tens of ms. Queries outside the built range fall back to
+//  the direct model. Read only once built / loaded, so a single instance can be shared between
+//  threads.
+//
+
+#ifndef __ofxSunCalcChebyshev__
+#define __ofxSunCalcChebyshev__
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "ofxSunCalcCore.h"
+
+class ofxSunCalcChebyshev {
+
+public:
+
+    enum Body {
+        BODY_SUN,   // channels x, y, z
+        BODY_MOON,  // channels x, y, z, distance (km)
+        numBodies
+    };
+
+    typedef struct {
+        double segmentDays;
+        uint32_t numSegments;
+        uint32_t numCoefficients;   // polynomial degree + 1
+        uint32_t numChannels;
+        uint32_t reserved;
+        uint64_t offset;            // bytes from the blob start
+    } BodyHeader;
+
+    typedef struct {
+        char magic[8];              // "SCCHEBY\0"
+        uint32_t version;
+        uint32_t byteOrder;         // byteOrderMark as written
+        uint32_t headerSize;
+        uint32_t bodyCount;         // numBodies
+        double startJ;
+        double endJ;
+        uint64_t size;              // whole blob, bytes
+        BodyHeader bodies[numBodies];
+        uint64_t reserved[2];
+    } Header;
+
+    static const uint32_t version = 1;
+    static const uint32_t byteOrderMark = 0x01020304;
+    static const uint32_t maxCoefficients = 32;
+
+    ofxSunCalcChebyshev() {
+    }
+
+    // Fits both bodies over [startJ, endJ). Returns false (and stays empty) for an empty range or
+    // a segment / coefficient count out of range (segmentDays > 0, 2 .. maxCoefficients).
+    bool build( double startJ, double endJ,
+                double sunSegmentDays = 32, int sunCoefficients = 10,
+                double moonSegmentDays = 4, int moonCoefficients = 11 );
+
+    bool save( const std::string & path ) const;
+
+    // Returns false (and stays empty) if the file / blob is missing, truncated, of another
+    // version or of a foreign byte order.
+    bool load( const std::string & path );
+    bool setBlob( const void * data, size_t size );
+
+    void clear() { blob.clear(); }
+
+    bool isLoaded() const noexcept { return !blob.empty(); }
+    const void * getBlob() const noexcept { return blob.data(); }
+    size_t getBlobSize() const noexcept { return blob.size() * sizeof(double); }
+    const Header & getHeader() const noexcept { return *(const Header *)blob.data(); }
+
+    double getStartJulianDate() const noexcept { return isLoaded() ? getHeader().startJ : 0; }
+    double getEndJulianDate() const noexcept { return isLoaded() ? getHeader().endJ : 0; }
+    bool contains( double J ) const noexcept {
+        return isLoaded() && J >= getHeader().startJ && J < getHeader().endJ;
+    }
+
+    // Equatorial unit vector of the sun at J (3 values), and of the moon plus its distance in km
+    // (4 values).
+    void getSunVector( double J, double * out ) const noexcept {
+        if(!evaluate(BODY_SUN, J, out)) directSun(J, out);
+    }
+
+    void getMoonVector( double J, double * out ) const noexcept {
+        if(!evaluate(BODY_MOON, J, out)) directMoon(J, out);
+    }
+
+    // As ofxSunCalcCore::getSunPosition( J, lw, phi )
+    SunCalcPosition getSunPosition( double J, double lw, double phi ) const noexcept {
+        double v[3] = { 0, 0, 0 };
+        getSunVector(J, v);
+        double ch, sh;
+        hourAngle(J, lw, v, ch, sh);
+
+        double sinphi = std::sin(phi);
+        double cosphi = std::cos(phi);
+        SunCalcPosition pos;
+        pos.azimuth = std::atan2(sh, ch * sinphi - v[2] * cosphi);
+        pos.altitude = std::asin(clampUnit(sinphi * v[2] + cosphi * ch));
+        return pos;
+    }
+
+    // As ofxSunCalcCore::getMoonPosition( J, lw, phi )
+    MoonCalcPosition getMoonPosition( double J, double lw, double phi ) const noexcept {
+        double v[4] = { 0, 0, 0, 0 };
+        getMoonVector(J, v);
+        double ch, sh;
+        hourAngle(J, lw, v, ch, sh);
+
+        double sinphi = std::sin(phi);
+        double cosphi = std::cos(phi);
+        double h = std::asin(clampUnit(sinphi * v[2] + cosphi * ch));
+
+        // the ofxSunCalcCore form scaled by cos(dec), which keeps the angle
+        double cos2dec = 1 - v[2] * v[2];
+        MoonCalcPosition mp;
+        mp.azimuth = std::atan2(sh, ch * sinphi - v[2] * cosphi);
+        mp.altitude = h + ofxSunCalcCore::astroRefraction(h);
+        mp.distance = v[3];
+        mp.parallacticAngle = std::atan2(sh, sinphi / cosphi * cos2dec - v[2] * ch);
+        return mp;
+    }
+
+    // With the observer's precomputed latitude terms: a query is the Clenshaw sums, one sine /
+    // cosine of the sidereal time and the atan2 / asin.
+    SunCalcPosition getSunPosition( double J, const SunCalcObserver & observer ) const noexcept {
+        double v[3] = { 0, 0, 0 };
+        getSunVector(J, v);
+        double ch, sh;
+        hourAngle(J, observer.lw, v, ch, sh);
+
+        SunCalcPosition pos;
+        pos.azimuth = std::atan2(sh, ch * observer.sinPhi - v[2] * observer.cosPhi);
+        pos.altitude = std::asin(clampUnit(observer.sinPhi * v[2] + observer.cosPhi * ch));
+        return pos;
+    }
+
+    MoonCalcPosition getMoonPosition( double J, const SunCalcObserver & observer ) const noexcept {
+        double v[4] = { 0, 0, 0, 0 };
+        getMoonVector(J, v);
+        double ch, sh;
+        hourAngle(J, observer.lw, v, ch, sh);
+        double h = std::asin(clampUnit(observer.sinPhi * v[2] + observer.cosPhi * ch));
+
+        MoonCalcPosition mp;
+        mp.azimuth = std::atan2(sh, ch * observer.sinPhi - v[2] * observer.cosPhi);
+        mp.altitude = h + observer.refraction * ofxSunCalcCore::astroRefraction(h);
+        mp.distance = v[3];
+        mp.parallacticAngle = std::atan2(sh, observer.tanPhi * (1 - v[2] * v[2]) - v[2] * ch);
+        return mp;
+    }
+
+    // Many sites at one instant, the segment is only evaluated once.
+    void getSunPositions( double J, const double * lw, const double * phi, size_t count, double * azimuth, double * altitude ) const noexcept;
+
+private:
+
+    // Clenshaw sums of every channel of body at J, false when J is outside the blob.
+    bool evaluate( Body body, double J, double * out ) const noexcept {
+        if(!contains(J)) return false;
+        const Header & h = getHeader();
+        const BodyHeader & b = h.bodies[body];
+
+        double x = (J - h.startJ) / b.segmentDays;
+        uint32_t s = (uint32_t)x;
+        if(s >= b.numSegments) s = b.numSegments - 1;
+        double t = 2 * (x - s) - 1;
+        double t2 = 2 * t;
+
+        const double * c = (const double *)((const unsigned char *)blob.data() + b.offset)
+            + (size_t)s * b.numChannels * b.numCoefficients;
+        for(uint32_t ch = 0; ch < b.numChannels; ch++, c += b.numCoefficients) {
+            double b1 = 0, b2 = 0;
+            for(uint32_t k = b.numCoefficients - 1; k > 0; k--) {
+                double b0 = c[k] + t2 * b1 - b2;
+                b2 = b1;
+                b1 = b0;
+            }
+            out[ch] = c[0] + t * b1 - b2;
+        }
+        return true;
+    }
+
+    // cos(H) cos(dec) / sin(H) cos(dec) of the hour angle H = sidereal time - ra, from the vector
+    static void hourAngle( double J, double lw, const double * v, double & ch, double & sh ) noexcept {
+        double th = ofxSunCalcCore::getSiderealTime(J, lw);
+        double ct = std::cos(th);
+        double st = std::sin(th);
+        ch = v[0] * ct + v[1] * st;
+        sh = v[0] * st - v[1] * ct;
+    }
+
+    static double clampUnit( double x ) noexcept {
+        return x > 1 ? 1 : (x < -1 ? -1 : x);
+    }
+
+    static void directSun( double J, double * out ) noexcept {
+        using namespace ofxSunCalcCore;
+        double M = getSolarMeanAnomaly(J);
+        double C = getEquationOfCenter(M);
+        double Lsun = getEclipticLongitude(M, C);
+        toVector(getRightAscension(Lsun), getSunDeclination(Lsun), out);
+    }
+
+    static void directMoon( double J, double * out ) noexcept {
+        double ra, dec;
+        ofxSunCalcCore::getMoonCoords(J - ofxSunCalcCore::J2000, ra, dec, out[3]);
+        toVector(ra, dec, out);
+    }
+
+    static void toVector( double ra, double dec, double * out ) noexcept {
+        double cd = std::cos(dec);
+        out[0] = cd * std::cos(ra);
+        out[1] = cd * std::sin(ra);
+        out[2] = std::sin(dec);
+    }
+
+    // 8 byte aligned storage for the blob
+    std::vector<double> blob;
+
+};
+
+#endif /* defined(__ofxSunCalcChebyshev__) */
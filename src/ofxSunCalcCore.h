@@ -0,0 +1,419 @@
+//
+//  ofxSunCalcCore.h
+//
+//  Header only, dependency free core of ofxSunCalc: the constants and pure functions of
+//  the sun / moon model as free inline functions. Usable without openFrameworks or Poco,
+//  ofxSunCalc itself is a thin layer over this.
+//
+//  Angles are in radians, dates are Julian days, lw is the west longitude (-lon) and phi the latitude.
+//
+
+#ifndef __ofxSunCalcCore__
+#define __ofxSunCalcCore__
+
+/*
+ (c) 2011-2014, Vladimir Agafonkin
+ SunCalc is a JavaScript library for calculating sun/mooon position and light phases.
+ https://github.com/mourner/suncalc
+ */
+
+#include <cmath>
+#include <cstdint>
+
+typedef struct {
+    double azimuth;
+    double altitude;
+} SunCalcPosition;
+
+typedef struct {
+    double azimuth;
+    double altitude;
+    double distance;
+    double parallacticAngle;
+} MoonCalcPosition;
+
+// A location in degrees, lat positive north / lon positive east (as passed to ofxSunCalc).
+typedef struct {
+    double lat;
+    double lon;
+} SunCalcSite;
+
+// A site with its site invariant terms precomputed (ofxSunCalcCore::getObserver), for fixed
+// sites queried over and over: the lw / phi forms redo the latitude trig on every call.
+typedef struct {
+    double lat;             // degrees, as SunCalcSite
+    double lon;
+    double lw;              // radians, as the lw / phi arguments
+    double phi;
+    double sinPhi;
+    double cosPhi;
+    double tanPhi;
+    double elevation;       // metres above the horizon the observer sees
+    double refraction;      // astroRefraction scale, 1 at standard pressure / temperature, 0 for none
+    double sinAlt[5];       // sin of the day event altitudes h0, h0 + d0, h1, h2, h3 as corrected
+} SunCalcObserver;
+
+// Day events as raw Julian dates, a plain 96 byte POD (vs Poco::DateTime based SunCalcDayInfo).
+// Events that do not happen are NaN, the extended twilight fields are NaN unless computed with
+// detailed = true. polarDay / polarNight say why sunrise / sunset are missing: the sun stays
+// above / below the horizon all day. Convert with ofxSunCalc::julianDateToDate or
+// ofxSunCalcCore::julianDateToEpochMs only when needed.
+typedef struct {
+    double nightEnd;        // morning astronomical twilight start
+    double nauticalDawn;    // morning nautical twilight start
+    double dawn;            // morning civil twilight start
+    double sunriseStart;
+    double sunriseEnd;
+    double transit;
+    double sunsetStart;
+    double sunsetEnd;
+    double dusk;            // evening civil twilight end
+    double nauticalDusk;    // evening nautical twilight end
+    double nightStart;      // evening astronomical twilight end
+    bool detailed;
+    bool polarDay;          // no sunset, the sun is up all day
+    bool polarNight;        // no sunrise, the sun is down all day
+} SunCalcDayTimes;
+
+namespace ofxSunCalcCore {
+
+    constexpr double pi = 3.14159265358979323846;
+
+    constexpr double J1970 = 2440588;
+    constexpr double J2000 = 2451545;
+    constexpr double dayMs = 1000 * 60 * 60 * 24;
+    constexpr double deg2rad = pi / 180.0;
+    constexpr double M0 = 357.5291 * deg2rad;
+    constexpr double M1 = 0.98560028 * deg2rad;
+    constexpr double J0 = 0.0009;
+    constexpr double J1 = 0.0053;
+    constexpr double J2 = -0.0069;
+    constexpr double C1 = 1.9148 * deg2rad;
+    constexpr double C2 = 0.0200 * deg2rad;
+    constexpr double C3 = 0.0003 * deg2rad;
+    constexpr double P = 102.9372 * deg2rad;
+    constexpr double e = 23.4397 * deg2rad; // obliquity of the Earth
+    constexpr double th0 = 280.1600 * deg2rad;
+    constexpr double th1 = 360.9856235 * deg2rad;
+    constexpr double h0 = -0.833 * deg2rad; //sunset angle
+    constexpr double d0 = 0.53 * deg2rad; //sun diameter
+    constexpr double h1 = -6 * deg2rad; //nautical twilight angle
+    constexpr double h2 = -12 * deg2rad; //astronomical twilight angle
+    constexpr double h3 = -18 * deg2rad; //darkness angle
+    constexpr double JUnixEpoch = 2440587.5; // 1970-01-01 00:00 UTC
+
+    // dates
+
+    inline int64_t julianDateToEpochMs( double J ) noexcept {
+        return (int64_t)std::floor((J - JUnixEpoch) * dayMs + 0.5);
+    }
+
+    constexpr double epochMsToJulianDate( int64_t ms ) noexcept {
+        return ms / dayMs + JUnixEpoch;
+    }
+
+    // sun
+
+    inline int getJulianCycle( double J, double lw ) noexcept {
+        return (int)std::round(J - J2000 - J0 - lw/(2 * pi));
+    }
+
+    constexpr double getApproxSolarTransit( double Ht, double lw, double n ) noexcept {
+        return J2000 + J0 + (Ht + lw)/(2 * pi) + n;
+    }
+
+    constexpr double getSolarMeanAnomaly( double Js ) noexcept {
+        return M0 + M1 * (Js - J2000);
+    }
+
+    inline double getEquationOfCenter( double M ) noexcept {
+        return C1 * std::sin(M) + C2 * std::sin(2 * M) + C3 * std::sin(3 * M);
+    }
+
+    constexpr double getEclipticLongitude( double M, double C ) noexcept {
+        return M + P + C + pi;
+    }
+
+    inline double getSolarTransit( double Js, double M, double Lsun ) noexcept {
+        return Js + (J1 * std::sin(M)) + (J2 * std::sin(2 * Lsun));
+    }
+
+    inline double getSunDeclination( double Lsun ) noexcept {
+        return std::asin(std::sin(Lsun) * std::sin(e));
+    }
+
+    inline double getRightAscension( double Lsun ) noexcept {
+        return std::atan2(std::sin(Lsun) * std::cos(e), std::cos(Lsun));
+    }
+
+    constexpr double getSiderealTime( double J, double lw ) noexcept {
+        return th0 + th1 * (J - J2000) - lw;
+    }
+
+    inline double getAzimuth( double th, double a, double phi, double d ) noexcept {
+        double H = th - a;
+        return std::atan2(std::sin(H), std::cos(H) * std::sin(phi) - std::tan(d) * std::cos(phi));
+    }
+
+    inline double getAltitude( double th, double a, double phi, double d ) noexcept {
+        double H = th - a;
+        return std::asin(std::sin(phi) * std::sin(d) + std::cos(phi) * std::cos(d) * std::cos(H));
+    }
+
+    inline double getHourAngle( double h, double phi, double d ) noexcept {
+        return std::acos((std::sin(h) - std::sin(phi) * std::sin(d)) / (std::cos(phi) * std::cos(d)));
+    }
+
+    inline double getSunsetJulianDate( double w0, double M, double Lsun, double lw, double n ) noexcept {
+        return getSolarTransit( getApproxSolarTransit(w0, lw, n), M, Lsun );
+    }
+
+    constexpr double getSunriseJulianDate( double Jtransit, double Jset ) noexcept {
+        return Jtransit - (Jset - Jtransit);
+    }
+
+    inline SunCalcPosition getSunPosition( double J, double lw, double phi ) noexcept {
+        double M = getSolarMeanAnomaly(J);
+        double C = getEquationOfCenter(M);
+        double Lsun = getEclipticLongitude(M, C);
+        double d = getSunDeclination(Lsun);
+        double a = getRightAscension(Lsun);
+        double th = getSiderealTime(J, lw);
+
+        SunCalcPosition pos;
+        pos.azimuth = getAzimuth( th, a, phi, d );
+        pos.altitude = getAltitude( th, a, phi, d );
+        return pos;
+    }
+
+    // Declination dependent terms shared by the hour angles of one day. noon / midnight are the
+    // sines of the sun's altitude at upper / lower transit; altitudes outside that range are never
+    // reached, which classifies polar day / night up front instead of through acos NaNs.
+    typedef struct {
+        double sinphisind;
+        double cosphicosd;
+        double noon;
+        double midnight;
+    } DayGeometry;
+
+    inline DayGeometry getDayGeometry( double sinphi, double cosphi, double d ) noexcept {
+        DayGeometry g;
+        g.sinphisind = sinphi * std::sin(d);
+        g.cosphicosd = cosphi * std::cos(d);
+        g.noon = g.sinphisind + g.cosphicosd;
+        g.midnight = g.sinphisind - g.cosphicosd;
+        return g;
+    }
+
+    inline DayGeometry getDayGeometry( double phi, double d ) noexcept {
+        return getDayGeometry(std::sin(phi), std::cos(phi), d);
+    }
+
+    // sin of h0, h0 + d0, h1, h2, h3 (std::sin isn't constexpr)
+    constexpr double sinH0 = -0.01453808050249695;
+    constexpr double sinH0D0 = -0.005288322984041892;
+    constexpr double sinH1 = -0.10452846326765347;
+    constexpr double sinH2 = -0.20791169081775934;
+    constexpr double sinH3 = -0.3090169943749474;
+    constexpr double sinDayAltitudes[5] = { sinH0, sinH0D0, sinH1, sinH2, sinH3 };
+
+    // as getHourAngle, NaN without the acos when sinAlt is never reached
+    inline double getHourAngle( const DayGeometry & g, double sinAlt ) noexcept {
+        if(sinAlt < g.midnight || sinAlt > g.noon) return NAN;
+        return std::acos((sinAlt - g.sinphisind) / g.cosphicosd);
+    }
+
+    inline void setPolarFlags( SunCalcDayTimes & t, const DayGeometry & g, double sinHorizon = sinH0 ) noexcept {
+        t.polarDay = g.midnight > sinHorizon;
+        t.polarNight = g.noon < sinHorizon;
+    }
+
+    // sinAlt: sines of the day event altitudes, as sinDayAltitudes
+    inline SunCalcDayTimes getDayTimes( double J, double lw, double sinphi, double cosphi, const double * sinAlt, bool detailed ) noexcept {
+        double n = getJulianCycle(J, lw);
+        double Js = getApproxSolarTransit(0, lw, n);
+        double M = getSolarMeanAnomaly(Js);
+        double C = getEquationOfCenter(M);
+        double Lsun = getEclipticLongitude(M, C);
+        double d = getSunDeclination(Lsun);
+        double Jtransit = getSolarTransit(Js, M, Lsun);
+
+        DayGeometry g = getDayGeometry(sinphi, cosphi, d);
+
+        // getSunsetJulianDate with the transit terms evaluated once
+        double a = J1 * std::sin(M);
+        double b = J2 * std::sin(2 * Lsun);
+        auto setting = [&](double sinAlt) {
+            double w = getHourAngle(g, sinAlt);
+            return std::isnan(w) ? NAN : getApproxSolarTransit(w, lw, n) + a + b;
+        };
+
+        SunCalcDayTimes t;
+        t.transit = Jtransit;
+        t.detailed = detailed;
+        setPolarFlags(t, g, sinAlt[0]);
+
+        // unreachable altitudes come back NaN from setting() without any trig
+        double Jset = setting(sinAlt[0]);
+        double Jsetstart = setting(sinAlt[1]);
+        double Jnau = setting(sinAlt[2]);
+        t.sunriseStart = getSunriseJulianDate(Jtransit, Jset);
+        t.sunriseEnd = getSunriseJulianDate(Jtransit, Jsetstart);
+        t.sunsetStart = Jsetstart;
+        t.sunsetEnd = Jset;
+        t.dawn = getSunriseJulianDate(Jtransit, Jnau);
+        t.dusk = Jnau;
+
+        if(detailed){
+            double Jastro = setting(sinAlt[3]);
+            double Jdark = setting(sinAlt[4]);
+            t.nauticalDusk = Jastro;
+            t.nightStart = Jdark;
+            t.nauticalDawn = getSunriseJulianDate(Jtransit, Jastro);
+            t.nightEnd = getSunriseJulianDate(Jtransit, Jdark);
+        }else{
+            t.nauticalDusk = t.nightStart = t.nauticalDawn = t.nightEnd = NAN;
+        }
+        return t;
+    }
+
+    inline SunCalcDayTimes getDayTimes( double J, double lw, double phi, bool detailed = false ) noexcept {
+        return getDayTimes(J, lw, std::sin(phi), std::cos(phi), sinDayAltitudes, detailed);
+    }
+
+    // moon
+
+    inline double rightAscension( double l, double b ) noexcept { return std::atan2(std::sin(l) * std::cos(e) - std::tan(b) * std::sin(e), std::cos(l)); }
+    inline double declination( double l, double b ) noexcept { return std::asin(std::sin(b) * std::cos(e) + std::cos(b) * std::sin(e) * std::sin(l)); }
+    inline double azimuth( double H, double phi, double dec ) noexcept { return std::atan2(std::sin(H), std::cos(H) * std::sin(phi) - std::tan(dec) * std::cos(phi)); }
+    inline double altitude( double H, double phi, double dec ) noexcept { return std::asin(std::sin(phi) * std::sin(dec) + std::cos(phi) * std::cos(dec) * std::cos(H)); }
+    constexpr double siderealTime( double d, double lw ) noexcept { return deg2rad * (280.16 + 360.9856235 * d) - lw; }
+    inline double astroRefraction( double h ) noexcept {
+        if (h < 0) // the following formula works for positive altitudes only.
+            h = 0; // if h = -0.08901179 a div/0 would occur.
+
+        // formula 16.4 of "Astronomical Algorithms" 2nd edition by Jean Meeus (Willmann-Bell, Richmond) 1998.
+        // 1.02 / tan(h + 10.26 / (h + 5.10)) h in degrees, result in arc minutes -> converted to rad:
+        return 0.0002967 / std::tan(h + 0.00312536 / (h + 0.08901179));
+    }
+
+    // geocentric moon coordinates for d = J - J2000
+    inline void getMoonCoords( double d, double & ra, double & dec, double & dist ) noexcept {
+        double rad = deg2rad;
+
+        double L = rad * (218.316 + 13.176396 * d); // ecliptic longitude
+        double M = rad * (134.963 + 13.064993 * d); // mean anomaly
+        double F = rad * (93.272 + 13.229350 * d);  // mean distance
+
+        double l = L + rad * 6.289 * std::sin(M);    // longitude
+        double b = rad * 5.128 * std::sin(F);        // latitude
+        dist = 385001 - 20905 * std::cos(M);         // distance to the moon in km
+
+        ra = rightAscension(l, b);
+        dec = declination(l, b);
+    }
+
+    inline MoonCalcPosition getMoonPosition( double J, double lw, double phi ) noexcept {
+        double d = J - J2000;
+        double ra, dec, dt;
+        getMoonCoords(d, ra, dec, dt);
+
+        double H = siderealTime(d, lw) - ra;
+        double h = altitude(H, phi, dec);
+
+        // formula 14.1 of "Astronomical Algorithms" 2nd edition by Jean Meeus (Willmann-Bell, Richmond) 1998.
+        double pa = std::atan2(std::sin(H), std::tan(phi) * std::cos(dec) - std::sin(dec) * std::cos(H));
+        h = h + astroRefraction(h); // altitude correction for refraction
+
+        MoonCalcPosition mp;
+        mp.azimuth = azimuth(H, phi, dec);
+        mp.altitude = h;
+        mp.distance = dt;
+        mp.parallacticAngle = pa;
+        return mp;
+    }
+
+    // observer
+
+    constexpr double standardPressure = 1010;   // hPa
+    constexpr double standardTemperature = 10;  // C
+    constexpr double standardRefraction = 34.0 / 60 * deg2rad; // part of h0
+
+    // Dip of the horizon seen from elevation metres up (negative, radians), as suncalc's observerAngle.
+    inline double getHorizonDip( double elevation ) noexcept {
+        return elevation > 0 ? -2.076 * std::sqrt(elevation) / 60 * deg2rad : 0;
+    }
+
+    // lat / lon in degrees. elevation lowers every day event altitude by the horizon dip, so events
+    // come as seen from a roof or hill top. pressure (hPa) and temperature (C) scale the refraction
+    // (Meeus 16.), of the moon altitude and of the 34' in the sunrise / sunset altitudes. The
+    // defaults give exactly the lw / phi results.
+    inline SunCalcObserver getObserver( double lat, double lon, double elevation = 0, double pressure = standardPressure, double temperature = standardTemperature ) noexcept {
+        SunCalcObserver o;
+        o.lat = lat;
+        o.lon = lon;
+        o.lw = -lon * deg2rad;
+        o.phi = lat * deg2rad;
+        o.sinPhi = std::sin(o.phi);
+        o.cosPhi = std::cos(o.phi);
+        o.tanPhi = std::tan(o.phi);
+        o.elevation = elevation;
+        o.refraction = pressure / standardPressure * (273 + standardTemperature) / (273 + temperature);
+
+        double dip = getHorizonDip(elevation);
+        if(dip == 0 && o.refraction == 1) {
+            for(int i = 0; i < 5; i++) o.sinAlt[i] = sinDayAltitudes[i];
+        }else{
+            double horizon = h0 + (1 - o.refraction) * standardRefraction + dip;
+            o.sinAlt[0] = std::sin(horizon);
+            o.sinAlt[1] = std::sin(horizon + d0);
+            o.sinAlt[2] = std::sin(h1 + dip);
+            o.sinAlt[3] = std::sin(h2 + dip);
+            o.sinAlt[4] = std::sin(h3 + dip);
+        }
+        return o;
+    }
+
+    inline SunCalcObserver getObserver( const SunCalcSite & site, double elevation = 0 ) noexcept {
+        return getObserver(site.lat, site.lon, elevation);
+    }
+
+    inline SunCalcPosition getSunPosition( double J, const SunCalcObserver & o ) noexcept {
+        double M = getSolarMeanAnomaly(J);
+        double C = getEquationOfCenter(M);
+        double Lsun = getEclipticLongitude(M, C);
+        double d = getSunDeclination(Lsun);
+        double H = getSiderealTime(J, o.lw) - getRightAscension(Lsun);
+        double cosH = std::cos(H);
+
+        SunCalcPosition pos;
+        pos.azimuth = std::atan2(std::sin(H), cosH * o.sinPhi - std::tan(d) * o.cosPhi);
+        pos.altitude = std::asin(o.sinPhi * std::sin(d) + o.cosPhi * std::cos(d) * cosH);
+        return pos;
+    }
+
+    inline MoonCalcPosition getMoonPosition( double J, const SunCalcObserver & o ) noexcept {
+        double d = J - J2000;
+        double ra, dec, dt;
+        getMoonCoords(d, ra, dec, dt);
+
+        double H = siderealTime(d, o.lw) - ra;
+        double sinH = std::sin(H), cosH = std::cos(H);
+        double sind = std::sin(dec), cosd = std::cos(dec);
+        double h = std::asin(o.sinPhi * sind + o.cosPhi * cosd * cosH);
+
+        MoonCalcPosition mp;
+        mp.azimuth = std::atan2(sinH, cosH * o.sinPhi - std::tan(dec) * o.cosPhi);
+        mp.altitude = h + o.refraction * astroRefraction(h);
+        mp.distance = dt;
+        mp.parallacticAngle = std::atan2(sinH, o.tanPhi * cosd - sind * cosH);
+        return mp;
+    }
+
+    inline SunCalcDayTimes getDayTimes( double J, const SunCalcObserver & o, bool detailed = false ) noexcept {
+        return getDayTimes(J, o.lw, o.sinPhi, o.cosPhi, o.sinAlt, detailed);
+    }
+
+}
+
+#endif /* defined(__ofxSunCalcCore__) */
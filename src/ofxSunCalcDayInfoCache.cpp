@@ -0,0 +1,103 @@
+#include "ofxSunCalcDayInfoCache.h"
+
+#include <algorithm>
+#include <cmath>
+
+ofxSunCalcDayInfoCache::ofxSunCalcDayInfoCache( size_t capacity, double quantumDegrees, size_t numShards )
+: quantum(quantumDegrees > 0 ? quantumDegrees : 1e-4), hits(0), misses(0) {
+    if(numShards == 0) numShards = 1;
+    shardCapacity = std::max<size_t>(1, (capacity + numShards - 1) / numShards);
+    for(size_t i = 0; i < numShards; i++) {
+        shards.emplace_back(new Shard());
+    }
+}
+
+uint64_t ofxSunCalcDayInfoCache::KeyHash::mix( const Key & k ) {
+    // 64 bit mix of the fields (splitmix64 finalizer)
+    uint64_t h = (uint64_t)k.lat * 0x9E3779B97F4A7C15ULL;
+    h ^= (uint64_t)k.lon + 0x632BE59BD9B4E019ULL + (h << 6) + (h >> 2);
+    h ^= ((uint64_t)(uint32_t)k.cycle << 1 | (k.detailed ? 1 : 0)) + 0x9E3779B97F4A7C15ULL + (h << 6) + (h >> 2);
+    h ^= h >> 30;
+    h *= 0xBF58476D1CE4E5B9ULL;
+    h ^= h >> 27;
+    h *= 0x94D049BB133111EBULL;
+    h ^= h >> 31;
+    return h;
+}
+
+ofxSunCalcDayInfoCache::Shard & ofxSunCalcDayInfoCache::shardFor( const Key & key ) {
+    return *shards[(KeyHash::mix(key) >> 32) % shards.size()];
+}
+
+SunCalcDayInfo ofxSunCalcDayInfoCache::getDayInfo( const Poco::DateTime & date, double lat, double lon, bool detailed ) {
+    ofxSunCalc sun_calc;
+
+    Key key;
+    key.lat = (int64_t)std::llround(lat / quantum);
+    key.lon = (int64_t)std::llround(lon / quantum);
+    key.detailed = detailed;
+    // the cycle is what getDayTimes solves for, from the snapped longitude like the solve below
+    double qlat = key.lat * quantum;
+    double qlon = key.lon * quantum;
+    key.cycle = ofxSunCalcCore::getJulianCycle( sun_calc.dateToJulianDate(date), -qlon * ofxSunCalcCore::deg2rad );
+
+    Shard & shard = shardFor(key);
+    SunCalcDayInfo info;
+    {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        auto it = shard.index.find(key);
+        if(it != shard.index.end()) {
+            shard.entries.splice(shard.entries.begin(), shard.entries, it->second);
+            info = it->second->second;
+            hits++;
+            info.lat = lat;
+            info.lon = lon;
+            return info;
+        }
+    }
+
+    misses++;
+    info = sun_calc.getDayInfo(date, qlat, qlon, detailed);
+
+    {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        auto it = shard.index.find(key);
+        if(it != shard.index.end()) {
+            // another thread got here first
+            shard.entries.splice(shard.entries.begin(), shard.entries, it->second);
+        }else{
+            shard.entries.emplace_front(key, info);
+            shard.index.emplace(key, shard.entries.begin());
+            if(shard.entries.size() > shardCapacity) {
+                shard.index.erase(shard.entries.back().first);
+                shard.entries.pop_back();
+            }
+        }
+    }
+
+    info.lat = lat;
+    info.lon = lon;
+    return info;
+}
+
+void ofxSunCalcDayInfoCache::clear() {
+    for(auto & shard : shards) {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        shard->entries.clear();
+        shard->index.clear();
+    }
+}
+
+size_t ofxSunCalcDayInfoCache::size() const {
+    size_t n = 0;
+    for(auto & shard : shards) {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        n += shard->entries.size();
+    }
+    return n;
+}
+
+void ofxSunCalcDayInfoCache::resetCounters() {
+    hits = 0;
+    misses = 0;
+}
@@ -0,0 +1,80 @@
+//
+//  ofxSunCalcDayInfoCache.h
+//
+//  Memoizing front for ofxSunCalc::getDayInfo. A day info only changes with the Julian cycle
+//  (the solar day), so results are kept per (quantized lat, quantized lon, cycle, detailed)
+//  in a bounded LRU. Coordinates are snapped to a quantumDegrees grid (default 1e-4 degrees,
+//  ~11 m, well under a second of any event) and solved there, so every hit is exactly what
+//  the miss returned; lat / lon of the returned info are the caller's.
+//
+//  Thread safe: keys are spread over independently locked shards, each with its own LRU of
+//  capacity / numShards entries. Day infos are computed outside the lock.
+//
+
+#ifndef __ofxSunCalcDayInfoCache__
+#define __ofxSunCalcDayInfoCache__
+
+#include <atomic>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "ofxSunCalc.h"
+
+class ofxSunCalcDayInfoCache {
+
+public:
+
+    ofxSunCalcDayInfoCache( size_t capacity = 4096, double quantumDegrees = 1e-4, size_t numShards = 16 );
+
+    // As ofxSunCalc::getDayInfo.
+    SunCalcDayInfo getDayInfo( const Poco::DateTime & date, double lat, double lon, bool detailed = false );
+
+    void clear();
+    size_t size() const;
+
+    uint64_t getHits() const { return hits.load(); }
+    uint64_t getMisses() const { return misses.load(); }
+    void resetCounters();
+
+private:
+
+    struct Key {
+        int64_t lat;
+        int64_t lon;
+        int cycle;
+        bool detailed;
+        bool operator==( const Key & other ) const {
+            return lat == other.lat && lon == other.lon && cycle == other.cycle && detailed == other.detailed;
+        }
+    };
+
+    struct KeyHash {
+        // full 64 bits whatever the width of size_t, the shard takes the high half
+        static uint64_t mix( const Key & k );
+        size_t operator()( const Key & k ) const { return (size_t)mix(k); }
+    };
+
+    typedef std::list< std::pair<Key, SunCalcDayInfo> > Entries;
+
+    struct Shard {
+        std::mutex mutex;
+        Entries entries; // most recently used first
+        std::unordered_map<Key, Entries::iterator, KeyHash> index;
+    };
+
+    Shard & shardFor( const Key & key );
+
+    double quantum;
+    size_t shardCapacity;
+    std::vector< std::unique_ptr<Shard> > shards;
+
+    std::atomic<uint64_t> hits;
+    std::atomic<uint64_t> misses;
+
+};
+
+#endif /* defined(__ofxSunCalcDayInfoCache__) */
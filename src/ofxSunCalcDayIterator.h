@@ -0,0 +1,149 @@
+//
+//  ofxSunCalcDayIterator.h
+//
+//  Walks consecutive days at a fixed site, producing the same SunCalcDayTimes as
+//  ofxSunCalcCore::getDayTimes but stepping the solution forward from the previous day:
+//  the Julian cycle n and mean anomaly M advance linearly, so sin / cos of M (and of the
+//  ecliptic longitude base) are advanced by a fixed rotation rather than recomputed, and
+//  the declination is used through its sine only. What is left per day is one acos per event.
+//  The state is re-seeded exactly every reseedInterval days to keep rounding drift away.
+//
+//  Header only, no openFrameworks / Poco dependency.
+//
+
+#ifndef __ofxSunCalcDayIterator__
+#define __ofxSunCalcDayIterator__
+
+#include "ofxSunCalcCore.h"
+
+class ofxSunCalcDayIterator {
+
+public:
+
+    // Starts at the day containing Julian date J. lw / phi in radians as in ofxSunCalcCore.
+    ofxSunCalcDayIterator( double J, double lw, double phi, bool detailed = false ) noexcept
+    : lw(lw), detailed(detailed) {
+        n = ofxSunCalcCore::getJulianCycle(J, lw);
+
+        using namespace ofxSunCalcCore;
+        sinPhi = std::sin(phi);
+        cosPhi = std::cos(phi);
+        sinE = std::sin(e);
+        sinStep = std::sin(M1);
+        cosStep = std::cos(M1);
+
+        seed();
+        solve();
+    }
+
+    // degrees, as ofxSunCalc
+    ofxSunCalcDayIterator( double J, const SunCalcSite & site, bool detailed = false ) noexcept
+    : ofxSunCalcDayIterator( J, -site.lon * ofxSunCalcCore::deg2rad, site.lat * ofxSunCalcCore::deg2rad, detailed ) {
+    }
+
+    const SunCalcDayTimes & operator*() const noexcept { return times; }
+    const SunCalcDayTimes * operator->() const noexcept { return &times; }
+
+    ofxSunCalcDayIterator & operator++() noexcept {
+        n++;
+        if(++sinceSeed >= reseedInterval) {
+            seed();
+        }else{
+            // M and M + P + pi both advance by M1 per day
+            double s = sinM * cosStep + cosM * sinStep;
+            cosM = cosM * cosStep - sinM * sinStep;
+            sinM = s;
+            s = sinA * cosStep + cosA * sinStep;
+            cosA = cosA * cosStep - sinA * sinStep;
+            sinA = s;
+        }
+        solve();
+        return *this;
+    }
+
+    int getJulianCycle() const noexcept { return n; }
+
+    static const int reseedInterval = 64;
+
+private:
+
+    void seed() noexcept {
+        using namespace ofxSunCalcCore;
+        double Js = getApproxSolarTransit(0, lw, n);
+        double M = getSolarMeanAnomaly(Js);
+        sinM = std::sin(M);
+        cosM = std::cos(M);
+        sinA = std::sin(M + P + pi);
+        cosA = std::cos(M + P + pi);
+        sinceSeed = 0;
+    }
+
+    void solve() noexcept {
+        using namespace ofxSunCalcCore;
+
+        // equation of center from multiple angle identities
+        double sin2M = 2 * sinM * cosM;
+        double sin3M = sinM * (3 - 4 * sinM * sinM);
+        double C = C1 * sinM + C2 * sin2M + C3 * sin3M;
+
+        // Lsun = (M + P + pi) + C, |C| < 2 degrees so short series are exact to double precision
+        double CC = C * C;
+        double sinC = C * (1 - CC / 6 * (1 - CC / 20));
+        double cosC = 1 - CC / 2 * (1 - CC / 12 * (1 - CC / 30));
+        double sinL = sinA * cosC + cosA * sinC;
+        double cosL = cosA * cosC - sinA * sinC;
+
+        double sind = sinL * sinE;
+        double cosd = std::sqrt(1 - sind * sind);
+
+        DayGeometry g;
+        g.sinphisind = sinPhi * sind;
+        g.cosphicosd = cosPhi * cosd;
+        g.noon = g.sinphisind + g.cosphicosd;
+        g.midnight = g.sinphisind - g.cosphicosd;
+        setPolarFlags(times, g);
+
+        // getSolarTransit / getSunsetJulianDate, without the hour angle
+        double Jbase = J2000 + J0 + lw / (2 * pi) + n + J1 * sinM + J2 * (2 * sinL * cosL);
+        double Jtransit = Jbase;
+
+        double Jset = Jbase + getHourAngle(g, sinH0) / (2 * pi);
+        double Jsetstart = Jbase + getHourAngle(g, sinH0D0) / (2 * pi);
+        double Jnau = Jbase + getHourAngle(g, sinH1) / (2 * pi);
+
+        times.transit = Jtransit;
+        times.sunriseStart = getSunriseJulianDate(Jtransit, Jset);
+        times.sunriseEnd = getSunriseJulianDate(Jtransit, Jsetstart);
+        times.sunsetStart = Jsetstart;
+        times.sunsetEnd = Jset;
+        times.dawn = getSunriseJulianDate(Jtransit, Jnau);
+        times.dusk = Jnau;
+        times.detailed = detailed;
+
+        if(detailed){
+            double Jastro = Jbase + getHourAngle(g, sinH2) / (2 * pi);
+            double Jdark = Jbase + getHourAngle(g, sinH3) / (2 * pi);
+            times.nauticalDusk = Jastro;
+            times.nightStart = Jdark;
+            times.nauticalDawn = getSunriseJulianDate(Jtransit, Jastro);
+            times.nightEnd = getSunriseJulianDate(Jtransit, Jdark);
+        }else{
+            times.nauticalDusk = times.nightStart = times.nauticalDawn = times.nightEnd = NAN;
+        }
+    }
+
+    double lw;
+    bool detailed;
+    int n;
+    int sinceSeed;
+
+    double sinM, cosM;
+    double sinA, cosA; // A = M + P + pi, the ecliptic longitude without the equation of center
+    double sinStep, cosStep;
+    double sinPhi, cosPhi, sinE;
+
+    SunCalcDayTimes times;
+
+};
+
+#endif /* defined(__ofxSunCalcDayIterator__) */
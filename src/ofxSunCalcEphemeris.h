@@ -0,0 +1,226 @@
+//
+//  ofxSunCalcEphemeris.h
+//
+//  Table of the time only (location independent) part of the sun model: declination,
+//  right ascension and the transit correction (J1 sin M + J2 sin 2 Lsun), sampled at a fixed
+//  step over a date range. Positions / day times for any site are then answered by cubic
+//  interpolation in the table plus the site dependent trig, so thousands of sites queried
+//  for the same instants don't each redo the anomaly / ecliptic work.
+//
+//  Interpolation error vs the direct model: 1 day step < 1e-6 rad in position and < 0.1 s in
+//  day times, hourly or finer steps < 1e-9 rad. Queries outside the built range fall back to the direct model.
+//  Read only once built, so a single instance can be shared between threads.
+//
+//  Header only, no openFrameworks / Poco dependency.
+//
+
+#ifndef __ofxSunCalcEphemeris__
+#define __ofxSunCalcEphemeris__
+
+#include <vector>
+
+#include "ofxSunCalcCore.h"
+
+class ofxSunCalcEphemeris {
+
+public:
+
+    typedef struct {
+        double declination;
+        double rightAscension;  // unwrapped, continuous between samples
+        double transitOffset;   // J1 * sin(M) + J2 * sin(2 * Lsun), in days
+    } Sample;
+
+    static const size_t maxSamples = 1 << 28;
+
+    ofxSunCalcEphemeris() {
+    }
+
+    ofxSunCalcEphemeris( double startJ, double endJ, double stepDays = 1.0 ) {
+        build(startJ, endJ, stepDays);
+    }
+
+    // stepDays = 1.0 / 1440 for a per minute table. Returns false (and leaves the table empty,
+    // every query then uses the direct model) unless startJ <= endJ, stepDays > 0, all finite, and
+    // the table fits in maxSamples.
+    bool build( double startJ, double endJ, double stepDays = 1.0 ) {
+        using namespace ofxSunCalcCore;
+
+        samples.clear();
+        double intervals = (endJ - startJ) / stepDays;
+        if(!(std::isfinite(startJ) && std::isfinite(endJ) && stepDays > 0 && intervals >= 0 && intervals + 3 <= maxSamples)) {
+            return false;
+        }
+
+        step = stepDays;
+        // one extra sample either side so cubic interpolation works up to the range ends
+        start = startJ - step;
+        size_t count = (size_t)std::ceil(intervals) + 3;
+
+        samples.resize(count);
+        double prevRa = 0;
+        for(size_t i = 0; i < count; i++) {
+            double J = start + i * step;
+            double M = getSolarMeanAnomaly(J);
+            double C = getEquationOfCenter(M);
+            double Lsun = getEclipticLongitude(M, C);
+
+            Sample & s = samples[i];
+            s.declination = getSunDeclination(Lsun);
+            s.rightAscension = getRightAscension(Lsun);
+            s.transitOffset = J1 * std::sin(M) + J2 * std::sin(2 * Lsun);
+
+            if(i > 0) {
+                s.rightAscension += 2 * pi * std::round((prevRa - s.rightAscension) / (2 * pi));
+            }
+            prevRa = s.rightAscension;
+        }
+        return true;
+    }
+
+    bool contains( double J ) const noexcept {
+        return samples.size() >= 4 && J >= start + step && J <= start + (samples.size() - 2) * step;
+    }
+
+    double getStartJulianDate() const noexcept { return start + step; }
+    double getEndJulianDate() const noexcept { return start + (samples.size() - 2) * step; }
+    double getStep() const noexcept { return step; }
+    size_t size() const noexcept { return samples.size(); }
+
+    // Interpolated sample at J, or the direct model when J is outside the table.
+    Sample getSample( double J ) const noexcept {
+        if(!contains(J)) return direct(J);
+
+        double x = (J - start) / step;
+        size_t i = (size_t)x;
+        if(i < 1) i = 1;
+        if(i + 2 >= samples.size()) i = samples.size() - 3;
+        double t = x - i;
+
+        const Sample & p0 = samples[i - 1];
+        const Sample & p1 = samples[i];
+        const Sample & p2 = samples[i + 1];
+        const Sample & p3 = samples[i + 2];
+
+        Sample s;
+        s.declination = catmullRom(p0.declination, p1.declination, p2.declination, p3.declination, t);
+        s.rightAscension = catmullRom(p0.rightAscension, p1.rightAscension, p2.rightAscension, p3.rightAscension, t);
+        s.transitOffset = catmullRom(p0.transitOffset, p1.transitOffset, p2.transitOffset, p3.transitOffset, t);
+        return s;
+    }
+
+    // As ofxSunCalcCore::getSunPosition( J, lw, phi )
+    SunCalcPosition getSunPosition( double J, double lw, double phi ) const noexcept {
+        using namespace ofxSunCalcCore;
+        Sample s = getSample(J);
+        double th = getSiderealTime(J, lw);
+
+        SunCalcPosition pos;
+        pos.azimuth = getAzimuth( th, s.rightAscension, phi, s.declination );
+        pos.altitude = getAltitude( th, s.rightAscension, phi, s.declination );
+        return pos;
+    }
+
+    // As ofxSunCalcCore::getSunPosition( J, observer )
+    SunCalcPosition getSunPosition( double J, const SunCalcObserver & observer ) const noexcept {
+        using namespace ofxSunCalcCore;
+        Sample s = getSample(J);
+        double H = getSiderealTime(J, observer.lw) - s.rightAscension;
+        double cosH = std::cos(H);
+
+        SunCalcPosition pos;
+        pos.azimuth = std::atan2(std::sin(H), cosH * observer.sinPhi - std::tan(s.declination) * observer.cosPhi);
+        pos.altitude = std::asin(observer.sinPhi * std::sin(s.declination) + observer.cosPhi * std::cos(s.declination) * cosH);
+        return pos;
+    }
+
+    // Many sites at one instant, the table is only read once.
+    void getSunPositions( double J, const double * lw, const double * phi, size_t count, double * azimuth, double * altitude ) const noexcept {
+        using namespace ofxSunCalcCore;
+        Sample s = getSample(J);
+        double Ha = getSiderealTime(J, 0) - s.rightAscension;
+        double sind = std::sin(s.declination);
+        double cosd = std::cos(s.declination);
+        double tand = std::tan(s.declination);
+        for(size_t i = 0; i < count; i++) {
+            double H = Ha - lw[i];
+            double sinphi = std::sin(phi[i]);
+            double cosphi = std::cos(phi[i]);
+            azimuth[i] = std::atan2(std::sin(H), std::cos(H) * sinphi - tand * cosphi);
+            altitude[i] = std::asin(sinphi * sind + cosphi * cosd * std::cos(H));
+        }
+    }
+
+    // As ofxSunCalcCore::getDayTimes( J, lw, phi, detailed )
+    SunCalcDayTimes getDayTimes( double J, double lw, double phi, bool detailed = false ) const noexcept {
+        return getDayTimes(J, lw, std::sin(phi), std::cos(phi), ofxSunCalcCore::sinDayAltitudes, detailed);
+    }
+
+    // As ofxSunCalcCore::getDayTimes( J, observer, detailed )
+    SunCalcDayTimes getDayTimes( double J, const SunCalcObserver & observer, bool detailed = false ) const noexcept {
+        return getDayTimes(J, observer.lw, observer.sinPhi, observer.cosPhi, observer.sinAlt, detailed);
+    }
+
+private:
+
+    SunCalcDayTimes getDayTimes( double J, double lw, double sinphi, double cosphi, const double * sinAlt, bool detailed ) const noexcept {
+        using namespace ofxSunCalcCore;
+        double n = getJulianCycle(J, lw);
+        double Js = getApproxSolarTransit(0, lw, n);
+        Sample s = getSample(Js);
+        double d = s.declination;
+
+        // getSunsetJulianDate with M / Lsun taken at Js, as the direct model does
+        DayGeometry g = getDayGeometry(sinphi, cosphi, d);
+        double Jtransit = Js + s.transitOffset;
+        double Jset = getApproxSolarTransit(getHourAngle(g, sinAlt[0]), lw, n) + s.transitOffset;
+        double Jsetstart = getApproxSolarTransit(getHourAngle(g, sinAlt[1]), lw, n) + s.transitOffset;
+        double Jnau = getApproxSolarTransit(getHourAngle(g, sinAlt[2]), lw, n) + s.transitOffset;
+
+        SunCalcDayTimes t;
+        setPolarFlags(t, g, sinAlt[0]);
+        t.transit = Jtransit;
+        t.sunriseStart = getSunriseJulianDate(Jtransit, Jset);
+        t.sunriseEnd = getSunriseJulianDate(Jtransit, Jsetstart);
+        t.sunsetStart = Jsetstart;
+        t.sunsetEnd = Jset;
+        t.dawn = getSunriseJulianDate(Jtransit, Jnau);
+        t.dusk = Jnau;
+        t.detailed = detailed;
+
+        if(detailed){
+            double Jastro = getApproxSolarTransit(getHourAngle(g, sinAlt[3]), lw, n) + s.transitOffset;
+            double Jdark = getApproxSolarTransit(getHourAngle(g, sinAlt[4]), lw, n) + s.transitOffset;
+            t.nauticalDusk = Jastro;
+            t.nightStart = Jdark;
+            t.nauticalDawn = getSunriseJulianDate(Jtransit, Jastro);
+            t.nightEnd = getSunriseJulianDate(Jtransit, Jdark);
+        }else{
+            t.nauticalDusk = t.nightStart = t.nauticalDawn = t.nightEnd = NAN;
+        }
+        return t;
+    }
+
+    static double catmullRom( double p0, double p1, double p2, double p3, double t ) noexcept {
+        return p1 + 0.5 * t * (p2 - p0 + t * (2 * p0 - 5 * p1 + 4 * p2 - p3 + t * (3 * (p1 - p2) + p3 - p0)));
+    }
+
+    static Sample direct( double J ) noexcept {
+        using namespace ofxSunCalcCore;
+        double M = getSolarMeanAnomaly(J);
+        double C = getEquationOfCenter(M);
+        double Lsun = getEclipticLongitude(M, C);
+        Sample s;
+        s.declination = getSunDeclination(Lsun);
+        s.rightAscension = getRightAscension(Lsun);
+        s.transitOffset = J1 * std::sin(M) + J2 * std::sin(2 * Lsun);
+        return s;
+    }
+
+    double start = 0;
+    double step = 1;
+    std::vector<Sample> samples;
+
+};
+
+#endif /* defined(__ofxSunCalcEphemeris__) */
@@ -0,0 +1,168 @@
+//
+//  ofxSunCalcFastMath.h
+//
+//  Branch free polynomial approximations of the trig functions used by the
+//  sun / moon position hot path. Written so loops over them auto vectorize
+//  (SSE / AVX2 / AVX-512 / NEON), unlike calls into libm.
+//
+//  Max absolute error, measured over the input ranges used by ofxSunCalc:
+//      sin, cos        < 1e-11 for |x| < 1e4 rad, < 2e-10 for |x| < 1e6 rad (degree 15 after range reduction)
+//      atan, atan2     < 1e-13   (double argument halving, degree 15)
+//      asin, acos      < 1e-12   (via atan2, |x| <= 1)
+//      sqrt            ~ 2 ulp   (x >= 0)
+//  ie. well under a milliarcsecond, far below the accuracy of the sun / moon models themselves.
+//
+//  Selects are written so GCC / Clang can if-convert them without -ffast-math (which would
+//  also break roundNearest), loops vectorise at -O3. The batch entry points in ofxSunCalc
+//  (getSunPositionsFast, getMoonPositionsFast) are built on these.
+//
+
+#ifndef __ofxSunCalcFastMath__
+#define __ofxSunCalcFastMath__
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+// GCC / Clang on x86 build the batch kernels once per instruction set and pick the best one
+// at load time via CPUID. Other compilers / architectures (eg. aarch64, where NEON is always
+// available) get the single default build.
+// Needs ifunc support, so is limited to linux.
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__)) && defined(__linux__) && !defined(OFX_SUNCALC_NO_TARGET_CLONES)
+    #define OFX_SUNCALC_TARGET_CLONES __attribute__((target_clones("avx512f", "avx2", "default")))
+#else
+    #define OFX_SUNCALC_TARGET_CLONES
+#endif
+
+// GCC only vectorises loops with a remainder at -O3 (-O2 uses the "very cheap" cost model),
+// ask for the O3 cost model on the kernels so they vectorise in -O2 builds too.
+#if defined(__GNUC__) && !defined(__clang__)
+    #define OFX_SUNCALC_VECTORIZE OFX_SUNCALC_TARGET_CLONES __attribute__((optimize("vect-cost-model=dynamic")))
+#else
+    #define OFX_SUNCALC_VECTORIZE OFX_SUNCALC_TARGET_CLONES
+#endif
+
+// Cloned kernels carry their own target attributes, which can stop plain inline functions
+// being inlined into them. Force it, the functions are tiny.
+#if defined(__GNUC__) || defined(__clang__)
+    #define OFX_SUNCALC_FAST_INLINE inline __attribute__((always_inline))
+#else
+    #define OFX_SUNCALC_FAST_INLINE inline
+#endif
+
+namespace ofxSunCalcFastMath {
+
+    constexpr double pi = 3.14159265358979323846;
+    constexpr double halfPi = pi * 0.5;
+    constexpr double twoPi = pi * 2.0;
+    constexpr double invTwoPi = 1.0 / twoPi;
+
+    // sin on [-pi/2, pi/2], odd taylor terms up to x^15
+    OFX_SUNCALC_FAST_INLINE double sinPoly( double x ) noexcept {
+        double x2 = x * x;
+        double p = -7.647163731819816e-13;      // -1/15!
+        p = p * x2 + 1.6059043836821613e-10;    //  1/13!
+        p = p * x2 - 2.505210838544172e-08;     // -1/11!
+        p = p * x2 + 2.7557319223985893e-06;    //  1/9!
+        p = p * x2 - 1.984126984126984e-04;     // -1/7!
+        p = p * x2 + 8.333333333333333e-03;     //  1/5!
+        p = p * x2 - 1.666666666666667e-01;     // -1/3!
+        return x + x * x2 * p;
+    }
+
+    // round to nearest for |x| < 2^51 without a (non vectorisable) call to floor / nearbyint
+    OFX_SUNCALC_FAST_INLINE double roundNearest( double x ) noexcept {
+        constexpr double magic = 6755399441055744.0; // 1.5 * 2^52
+        return (x + magic) - magic;
+    }
+
+    OFX_SUNCALC_FAST_INLINE double sin( double x ) noexcept {
+        // reduce to [-pi, pi] then fold into [-pi/2, pi/2]
+        double y = x - twoPi * roundNearest(x * invTwoPi);
+        double hi = pi - y;
+        double lo = -pi - y;
+        y = hi < y ? hi : y;
+        y = lo > y ? lo : y;
+        return sinPoly(y);
+    }
+
+    OFX_SUNCALC_FAST_INLINE double cos( double x ) noexcept {
+        return sin(x + halfPi);
+    }
+
+    OFX_SUNCALC_FAST_INLINE double tan( double x ) noexcept {
+        return sin(x) / cos(x);
+    }
+
+    // std::sqrt has to set errno on negative input which keeps it out of vectorised loops
+    // (without -fno-math-errno). Bit trick estimate of 1/sqrt refined by four newton steps
+    // instead, accurate to a couple of ulp. x must be >= 0.
+    OFX_SUNCALC_FAST_INLINE double sqrt( double x ) noexcept {
+        std::uint64_t i;
+        std::memcpy(&i, &x, sizeof(i));
+        i = 0x5fe6eb50c7b537a9ULL - (i >> 1);
+        double y;
+        std::memcpy(&y, &i, sizeof(y));
+        double hx = 0.5 * x;
+        y = y * (1.5 - hx * y * y);
+        y = y * (1.5 - hx * y * y);
+        y = y * (1.5 - hx * y * y);
+        y = y * (1.5 - hx * y * y);
+        return x * y;
+    }
+
+    // atan for a in [0, 1]
+    OFX_SUNCALC_FAST_INLINE double atanUnit( double a ) noexcept {
+        // atan(a) = 2 atan(a / (1 + sqrt(1 + a^2))), applied twice leaves |u| <= tan(pi/16)
+        double u = a / (1.0 + sqrt(1.0 + a * a));
+        u = u / (1.0 + sqrt(1.0 + u * u));
+        double u2 = u * u;
+        double p = 1.0 / 15.0;
+        p = p * u2 - 1.0 / 13.0;
+        p = p * u2 + 1.0 / 11.0;
+        p = p * u2 - 1.0 / 9.0;
+        p = p * u2 + 1.0 / 7.0;
+        p = p * u2 - 1.0 / 5.0;
+        p = p * u2 + 1.0 / 3.0;
+        return 4.0 * (u - u * u2 * p);
+    }
+
+    // atan2 for x >= 0
+    OFX_SUNCALC_FAST_INLINE double atan2Right( double y, double x ) noexcept {
+        double ay = std::fabs(y);
+        double mx = x > ay ? x : ay;
+        double mn = x > ay ? ay : x;
+        // selects done arithmetically, which GCC is happier to if-convert and vectorise
+        double r = atanUnit(mn / (mx + (mx == 0)));
+        r += (ay > x) * (halfPi - 2.0 * r);
+        return std::copysign(r, y);
+    }
+
+    OFX_SUNCALC_FAST_INLINE double atan2( double y, double x ) noexcept {
+        double ax = std::fabs(x);
+        double ay = std::fabs(y);
+        double mx = ax > ay ? ax : ay;
+        double mn = ax > ay ? ay : ax;
+        double r = atanUnit(mn / (mx + (mx == 0)));
+        r += (ay > ax) * (halfPi - 2.0 * r);
+        r += (x < 0) * (pi - 2.0 * r);
+        return std::copysign(r, y);
+    }
+
+    OFX_SUNCALC_FAST_INLINE double atan( double x ) noexcept {
+        return atan2(x, 1.0);
+    }
+
+    OFX_SUNCALC_FAST_INLINE double asin( double x ) noexcept {
+        double c = 1.0 - x * x;
+        return atan2Right(x, sqrt(std::fabs(c)));
+    }
+
+    OFX_SUNCALC_FAST_INLINE double acos( double x ) noexcept {
+        double s = 1.0 - x * x;
+        return atan2(sqrt(std::fabs(s)), x);
+    }
+
+}
+
+#endif /* defined(__ofxSunCalcFastMath__) */
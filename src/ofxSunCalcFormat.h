@@ -0,0 +1,126 @@
+//
+//  ofxSunCalcFormat.h
+//
+//  Allocation free, fixed width date / time text. Writes into a caller buffer (to_chars style)
+//  instead of building a std::string per timestamp, for per frame HUDs and logging.
+//  Output matches ofxSunCalc::dateTo*String: "YYYY-MM-DD", "HH:MM:SS", "YYYY-MM-DD HH:MM:SS",
+//  and "n.a." for events that do not happen (NaN Julian dates).
+//
+//  Header only, no openFrameworks / Poco dependency.
+//
+
+#ifndef __ofxSunCalcFormat__
+#define __ofxSunCalcFormat__
+
+#include <cstddef>
+
+#include "ofxSunCalcCore.h"
+#include "ofxSunCalcStats.h"
+
+namespace ofxSunCalcFormat {
+
+    // buffer sizes including the terminating 0
+    constexpr size_t dateSize = 11;
+    constexpr size_t timeSize = 9;
+    constexpr size_t dateTimeSize = 20;
+
+    constexpr double JGregorian = 2299160.5; // 1582-10-15 00:00 UTC, the Poco::DateTime epoch
+    constexpr long long ticksPerDay = 864000000000LL; // 100 ns ticks
+
+    // zero padded, v must fit in width digits
+    inline char * writeDigits( char * out, int v, int width ) noexcept {
+        for(int i = width - 1; i >= 0; i--) {
+            out[i] = (char)('0' + v % 10);
+            v /= 10;
+        }
+        return out + width;
+    }
+
+    inline size_t writeNotAvailable( char * out ) noexcept {
+        out[0] = 'n'; out[1] = '.'; out[2] = 'a'; out[3] = '.'; out[4] = 0;
+        return 4;
+    }
+
+    inline size_t formatDate( int year, int month, int day, char * out ) noexcept {
+        char * p = writeDigits(out, year, 4);
+        *p++ = '-';
+        p = writeDigits(p, month, 2);
+        *p++ = '-';
+        p = writeDigits(p, day, 2);
+        *p = 0;
+        return p - out;
+    }
+
+    inline size_t formatTime( int hour, int minute, int second, char * out ) noexcept {
+        char * p = writeDigits(out, hour, 2);
+        *p++ = ':';
+        p = writeDigits(p, minute, 2);
+        *p++ = ':';
+        p = writeDigits(p, second, 2);
+        *p = 0;
+        return p - out;
+    }
+
+    inline size_t formatDateTime( int year, int month, int day, int hour, int minute, int second, char * out ) noexcept {
+        size_t n = formatDate(year, month, day, out);
+        out[n++] = ' ';
+        return n + formatTime(hour, minute, second, out + n);
+    }
+
+    // UTC calendar fields of J, rounded to 100 ns then truncated to the second as
+    // Poco::DateTime( J ) does, so both paths print the same text.
+    inline void julianDateToCalendar( double J, int & year, int & month, int & day, int & hour, int & minute, int & second ) noexcept {
+        long long ticks = (long long)((J - JGregorian) * ticksPerDay + 0.5);
+        long long days = ticks / ticksPerDay;
+        long long rem = ticks % ticksPerDay;
+        if(rem < 0) {
+            rem += ticksPerDay;
+            days--;
+        }
+        int secs = (int)(rem / 10000000);
+        hour = secs / 3600;
+        minute = secs / 60 % 60;
+        second = secs % 60;
+
+        // civil from days (proleptic Gregorian), days counted from 0000-03-01
+        long long z = days + 578041; // 1582-10-15 is day 578041
+        long long era = (z >= 0 ? z : z - 146096) / 146097;
+        long long doe = z - era * 146097;
+        long long yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+        long long doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+        long long mp = (5 * doy + 2) / 153;
+        day = (int)(doy - (153 * mp + 2) / 5 + 1);
+        month = (int)(mp < 10 ? mp + 3 : mp - 9);
+        year = (int)(yoe + era * 400 + (month <= 2 ? 1 : 0));
+    }
+
+    inline size_t julianDateToDateChars( double J, char * out ) noexcept {
+        OFX_SUNCALC_STATS_SCOPE(FORMAT);
+        OFX_SUNCALC_STATS_SENTINEL(FORMAT, std::isnan(J));
+        if(std::isnan(J)) return writeNotAvailable(out);
+        int y, mo, d, h, mi, s;
+        julianDateToCalendar(J, y, mo, d, h, mi, s);
+        return formatDate(y, mo, d, out);
+    }
+
+    inline size_t julianDateToTimeChars( double J, char * out ) noexcept {
+        OFX_SUNCALC_STATS_SCOPE(FORMAT);
+        OFX_SUNCALC_STATS_SENTINEL(FORMAT, std::isnan(J));
+        if(std::isnan(J)) return writeNotAvailable(out);
+        int y, mo, d, h, mi, s;
+        julianDateToCalendar(J, y, mo, d, h, mi, s);
+        return formatTime(h, mi, s, out);
+    }
+
+    inline size_t julianDateToChars( double J, char * out ) noexcept {
+        OFX_SUNCALC_STATS_SCOPE(FORMAT);
+        OFX_SUNCALC_STATS_SENTINEL(FORMAT, std::isnan(J));
+        if(std::isnan(J)) return writeNotAvailable(out);
+        int y, mo, d, h, mi, s;
+        julianDateToCalendar(J, y, mo, d, h, mi, s);
+        return formatDateTime(y, mo, d, h, mi, s, out);
+    }
+
+}
+
+#endif /* defined(__ofxSunCalcFormat__) */
@@ -0,0 +1,45 @@
+#include "ofxSunCalcGrid.h"
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
+void ofxSunCalcGrid::getDayTimes( const std::vector<SunCalcSite> & sites, double startJ, int numDays, bool detailed,
+                                  std::vector<SunCalcDayTimes> & out, unsigned numThreads ) {
+    out.resize(sites.size() * std::max(numDays, 0));
+    getDayTimes( sites.data(), sites.size(), startJ, numDays, detailed, out.data(), numThreads );
+}
+
+void ofxSunCalcGrid::getDayTimes( const SunCalcSite * sites, size_t numSites, double startJ, int numDays, bool detailed,
+                                  SunCalcDayTimes * out, unsigned numThreads ) {
+    if(numDays <= 0 || numSites == 0) return;
+    
+    const size_t numCells = numSites * numDays;
+    const size_t numChunks = (numCells + chunkSize - 1) / chunkSize;
+    
+    std::atomic<size_t> nextChunk(0);
+    
+    auto worker = [&]() {
+        for(size_t chunk = nextChunk++; chunk < numChunks; chunk = nextChunk++) {
+            size_t end = std::min(numCells, (chunk + 1) * chunkSize);
+            for(size_t cell = chunk * chunkSize; cell < end; cell++) {
+                const SunCalcSite & site = sites[cell / numDays];
+                double J = startJ + (double)(cell % numDays);
+                out[cell] = ofxSunCalcCore::getDayTimes( J, -site.lon * ofxSunCalcCore::deg2rad, site.lat * ofxSunCalcCore::deg2rad, detailed );
+            }
+        }
+    };
+    
+    if(numThreads == 0) numThreads = std::max(1u, std::thread::hardware_concurrency());
+    numThreads = (unsigned)std::min<size_t>(numThreads, numChunks);
+    
+    std::vector<std::thread> threads;
+    threads.reserve(numThreads - 1);
+    for(unsigned i = 1; i < numThreads; i++) {
+        threads.emplace_back(worker);
+    }
+    worker(); // calling thread works too
+    for(auto & t : threads) {
+        t.join();
+    }
+}
@@ -0,0 +1,34 @@
+//
+//  ofxSunCalcGrid.h
+//
+//  Multithreaded day times over a (site x date) grid.
+//
+
+#ifndef __ofxSunCalcGrid__
+#define __ofxSunCalcGrid__
+
+#include <vector>
+
+#include "ofxSunCalcCore.h"
+
+class ofxSunCalcGrid {
+    
+public:
+    
+    // Fills out with the day times of every site for numDays consecutive days starting at
+    // Julian date startJ. Results are site major and do not depend on the thread count:
+    // out[site * numDays + day]. numThreads = 0 uses std::thread::hardware_concurrency().
+    static void getDayTimes( const std::vector<SunCalcSite> & sites, double startJ, int numDays, bool detailed,
+                             std::vector<SunCalcDayTimes> & out, unsigned numThreads = 0 );
+    
+    // As above writing to a caller owned table of sites.size() * numDays entries.
+    static void getDayTimes( const SunCalcSite * sites, size_t numSites, double startJ, int numDays, bool detailed,
+                             SunCalcDayTimes * out, unsigned numThreads = 0 );
+    
+    // Cells handed to a thread at a time. Threads pull the next chunk from a shared counter when
+    // done, so uneven chunks (eg. polar sites) balance out.
+    static const size_t chunkSize = 256;
+    
+};
+
+#endif /* defined(__ofxSunCalcGrid__) */
@@ -0,0 +1,183 @@
+//
+//  ofxSunCalcInverse.h
+//
+//  Inverse sun queries: when does the sun reach a given altitude, or cross a given azimuth.
+//
+//  Altitude: the hour angle of the altitude is solved in closed form (as getDayTimes does for
+//  its fixed angles), then polished by a few Newton steps on the hour angle with the
+//  declination / right ascension taken at the current estimate, so the result agrees with
+//  getSunPosition( J ).altitude to ~1e-9 rad (a few ms), typically in 2-3 iterations. The
+//  exception is an altitude the sun only just grazes (rise and set near local midnight at high
+//  latitude), where the iteration can stall on the closed form estimate, a few mrad out.
+//
+//  Azimuth: the day is sampled azimuthSamplesPerDay times to bracket crossings (azimuth is not
+//  monotonic in the tropics, so there can be up to two per day), each bracket is then solved
+//  by safeguarded Newton using the analytic d azimuth / d hour angle, falling back to
+//  bisection whenever a step would leave the bracket.
+//
+//  Angles in radians, azimuth from south towards west as getSunPosition. Results are Julian dates.
+//
+//  Header only, no openFrameworks / Poco dependency.
+//
+
+#ifndef __ofxSunCalcInverse__
+#define __ofxSunCalcInverse__
+
+#include <cstddef>
+
+#include "ofxSunCalcCore.h"
+
+// NaN rise / set when the altitude isn't crossed that day, the sun then stays above (alwaysAbove)
+// or below (alwaysBelow) it.
+typedef struct {
+    double rise;
+    double set;
+    bool alwaysAbove;
+    bool alwaysBelow;
+} SunCalcAltitudeTimes;
+
+namespace ofxSunCalcCore {
+
+    constexpr int azimuthSamplesPerDay = 48;
+    constexpr double inverseTolerance = 1e-8; // days, ~1 ms
+    constexpr int inverseMaxIterations = 8;
+
+    // declination / right ascension / hour angle of the sun at J
+    inline void getSunHourAngle( double J, double lw, double & H, double & d ) noexcept {
+        double M = getSolarMeanAnomaly(J);
+        double Lsun = getEclipticLongitude(M, getEquationOfCenter(M));
+        d = getSunDeclination(Lsun);
+        H = getSiderealTime(J, lw) - getRightAscension(Lsun);
+    }
+
+    // Newton on the hour angle towards +w (setting) or -w (rising), from estimate J.
+    inline double refineAltitudeTime( double J, double h, double lw, double phi, bool rising ) noexcept {
+        for(int i = 0; i < inverseMaxIterations; i++) {
+            double H, d;
+            getSunHourAngle(J, lw, H, d);
+            double w = getHourAngle(h, phi, d);
+            if(std::isnan(w)) break; // grazing the limit, keep the last estimate
+            double dJ = std::remainder((rising ? -w : w) - H, 2 * pi) / (2 * pi);
+            J += dJ;
+            if(std::fabs(dJ) < inverseTolerance) break;
+        }
+        return J;
+    }
+
+    // Shares the per day work (transit, declination) between altitudes.
+    inline void getAltitudeTimes( double J, double lw, double phi, const double * h, size_t count, SunCalcAltitudeTimes * out ) noexcept {
+        double n = getJulianCycle(J, lw);
+        double Js = getApproxSolarTransit(0, lw, n);
+        double M = getSolarMeanAnomaly(Js);
+        double Lsun = getEclipticLongitude(M, getEquationOfCenter(M));
+        double d = getSunDeclination(Lsun);
+        double Jtransit = getSolarTransit(Js, M, Lsun);
+
+        for(size_t i = 0; i < count; i++) {
+            SunCalcAltitudeTimes & t = out[i];
+            double w = getHourAngle(h[i], phi, d);
+            if(std::isnan(w)) {
+                // compare the noon altitude with the target
+                bool above = std::sin(phi) * std::sin(d) + std::cos(phi) * std::cos(d) > std::sin(h[i]);
+                t.rise = t.set = NAN;
+                t.alwaysAbove = above;
+                t.alwaysBelow = !above;
+                continue;
+            }
+            double Jset = getSunsetJulianDate(w, M, Lsun, lw, n);
+            t.set = refineAltitudeTime(Jset, h[i], lw, phi, false);
+            t.rise = refineAltitudeTime(getSunriseJulianDate(Jtransit, Jset), h[i], lw, phi, true);
+            t.alwaysAbove = t.alwaysBelow = false;
+        }
+    }
+
+    // Rise / set through altitude h on the solar day of J (the day getDayTimes( J, ... ) solves).
+    inline SunCalcAltitudeTimes getAltitudeTimes( double J, double lw, double phi, double h ) noexcept {
+        SunCalcAltitudeTimes t;
+        getAltitudeTimes(J, lw, phi, &h, 1, &t);
+        return t;
+    }
+
+    // numDays consecutive days from J, out must hold numDays entries.
+    inline void getAltitudeTimes( double J, int numDays, double lw, double phi, double h, SunCalcAltitudeTimes * out ) noexcept {
+        for(int day = 0; day < numDays; day++) {
+            getAltitudeTimes(J + day, lw, phi, &h, 1, out + day);
+        }
+    }
+
+    // azimuth - az wrapped to [-pi, pi], and its derivative per day
+    inline double azimuthOffset( double J, double lw, double phi, double az, double & slope ) noexcept {
+        double H, d;
+        getSunHourAngle(J, lw, H, d);
+        double sinphi = std::sin(phi);
+        double cosphi = std::cos(phi);
+        double tand = std::tan(d);
+        double x = std::cos(H) * sinphi - tand * cosphi;
+        double y = std::sin(H);
+        // d atan2(y, x) / dH, the hour angle advancing 2 pi per day
+        slope = (sinphi - tand * cosphi * std::cos(H)) / (x * x + y * y) * 2 * pi;
+        return std::remainder(std::atan2(y, x) - az, 2 * pi);
+    }
+
+    // Times in [J0, J1) at which the sun's azimuth passes az, in order. Writes at most maxCount
+    // and returns the number found.
+    inline size_t getAzimuthTimes( double J0, double J1, double lw, double phi, double az, double * out, size_t maxCount ) noexcept {
+        const double step = 1.0 / azimuthSamplesPerDay;
+        size_t found = 0;
+        double slope;
+        double Ja = J0;
+        double fa = azimuthOffset(Ja, lw, phi, az, slope);
+
+        while(Ja < J1 && found < maxCount) {
+            double Jb = std::fmin(Ja + step, J1);
+            double fb = azimuthOffset(Jb, lw, phi, az, slope);
+
+            // a sign change across a small gap is a crossing, across ~2 pi the wrap at az + pi
+            if(fa == 0) {
+                out[found++] = Ja;
+            }else if((fa < 0) != (fb < 0) && fb != 0 && std::fabs(fb - fa) < pi) {
+                double lo = Ja, hi = Jb, flo = fa;
+                double J = Ja - fa * (Jb - Ja) / (fb - fa);
+                for(int i = 0; i < inverseMaxIterations * 4; i++) {
+                    double f = azimuthOffset(J, lw, phi, az, slope);
+                    if((f < 0) == (flo < 0)) {
+                        lo = J;
+                        flo = f;
+                    }else{
+                        hi = J;
+                    }
+                    double next = J - f / slope;
+                    if(!(next > lo && next < hi)) next = 0.5 * (lo + hi);
+                    bool done = std::fabs(next - J) < inverseTolerance || hi - lo < inverseTolerance;
+                    J = next;
+                    if(done) break;
+                }
+                if(J < J1) out[found++] = J;
+            }
+            Ja = Jb;
+            fa = fb;
+        }
+        return found;
+    }
+
+    // At an observer's site (ofxSunCalcCore::getObserver). Altitudes are taken as given: the
+    // observer's horizon dip and refraction only move its day events, not an explicit target.
+    inline SunCalcAltitudeTimes getAltitudeTimes( double J, const SunCalcObserver & o, double h ) noexcept {
+        return getAltitudeTimes(J, o.lw, o.phi, h);
+    }
+
+    inline void getAltitudeTimes( double J, const SunCalcObserver & o, const double * h, size_t count, SunCalcAltitudeTimes * out ) noexcept {
+        getAltitudeTimes(J, o.lw, o.phi, h, count, out);
+    }
+
+    inline void getAltitudeTimes( double J, int numDays, const SunCalcObserver & o, double h, SunCalcAltitudeTimes * out ) noexcept {
+        getAltitudeTimes(J, numDays, o.lw, o.phi, h, out);
+    }
+
+    inline size_t getAzimuthTimes( double J0, double J1, const SunCalcObserver & o, double az, double * out, size_t maxCount ) noexcept {
+        return getAzimuthTimes(J0, J1, o.lw, o.phi, az, out, maxCount);
+    }
+
+}
+
+#endif /* defined(__ofxSunCalcInverse__) */
@@ -0,0 +1,129 @@
+//
+//  ofxSunCalcLazyDay.h
+//
+//  Day times evaluated per event on first access. The constructor does the per day work shared
+//  by every event (cycle, anomaly, ecliptic longitude, declination, transit), each pair of
+//  rising / setting events at one altitude then costs one hour angle (an acos) the first time
+//  either is read, and nothing after that. Values are the same as ofxSunCalcCore::getDayTimes
+//  for the same J / lw / phi, bit for bit.
+//
+//  Useful when only a few events are needed per site, eg. just nautical dusk for many sites.
+//  A handle is cheap to copy but not thread safe (getters fill the memo).
+//
+//  Header only, no openFrameworks / Poco dependency.
+//
+
+#ifndef __ofxSunCalcLazyDay__
+#define __ofxSunCalcLazyDay__
+
+#include <cstdint>
+
+#include "ofxSunCalcCore.h"
+
+class ofxSunCalcLazyDay {
+
+public:
+
+    ofxSunCalcLazyDay( double J, double lw, double phi )
+    : ofxSunCalcLazyDay( J, lw, std::sin(phi), std::cos(phi), ofxSunCalcCore::sinDayAltitudes ) {
+    }
+
+    // degrees, as ofxSunCalc
+    ofxSunCalcLazyDay( double J, const SunCalcSite & site )
+    : ofxSunCalcLazyDay( J, -site.lon * ofxSunCalcCore::deg2rad, site.lat * ofxSunCalcCore::deg2rad ) {
+    }
+
+    // with the observer's precomputed latitude terms and corrected altitudes, as
+    // ofxSunCalcCore::getDayTimes( J, observer )
+    ofxSunCalcLazyDay( double J, const SunCalcObserver & observer )
+    : ofxSunCalcLazyDay( J, observer.lw, observer.sinPhi, observer.cosPhi, observer.sinAlt ) {
+    }
+
+    double getTransit() const { return Jtransit; }
+    bool isPolarDay() const { return geometry.midnight > sinAlt[ALT_SUNSET]; }
+    bool isPolarNight() const { return geometry.noon < sinAlt[ALT_SUNSET]; }
+
+    // NaN when the event doesn't happen, as SunCalcDayTimes
+    double getSunriseStart() { return rising(ALT_SUNSET); }
+    double getSunriseEnd() { return rising(ALT_SUNSET_START); }
+    double getSunsetStart() { return setting(ALT_SUNSET_START); }
+    double getSunsetEnd() { return setting(ALT_SUNSET); }
+    double getDawn() { return rising(ALT_CIVIL); }
+    double getDusk() { return setting(ALT_CIVIL); }
+    double getNauticalDawn() { return rising(ALT_NAUTICAL); }
+    double getNauticalDusk() { return setting(ALT_NAUTICAL); }
+    double getNightEnd() { return rising(ALT_ASTRONOMICAL); }
+    double getNightStart() { return setting(ALT_ASTRONOMICAL); }
+
+    // Everything at once, as ofxSunCalcCore::getDayTimes( J, lw, phi, detailed ).
+    SunCalcDayTimes getDayTimes( bool detailed = false ) {
+        SunCalcDayTimes t;
+        t.transit = Jtransit;
+        t.detailed = detailed;
+        t.polarDay = isPolarDay();
+        t.polarNight = isPolarNight();
+        t.sunriseStart = getSunriseStart();
+        t.sunriseEnd = getSunriseEnd();
+        t.sunsetStart = getSunsetStart();
+        t.sunsetEnd = getSunsetEnd();
+        t.dawn = getDawn();
+        t.dusk = getDusk();
+        if(detailed) {
+            t.nauticalDawn = getNauticalDawn();
+            t.nauticalDusk = getNauticalDusk();
+            t.nightEnd = getNightEnd();
+            t.nightStart = getNightStart();
+        }else{
+            t.nauticalDusk = t.nightStart = t.nauticalDawn = t.nightEnd = NAN;
+        }
+        return t;
+    }
+
+private:
+
+    // setting altitudes: h0, h0 + d0, h1, h2, h3
+    enum Altitude { ALT_SUNSET, ALT_SUNSET_START, ALT_CIVIL, ALT_NAUTICAL, ALT_ASTRONOMICAL, numAltitudes };
+
+    ofxSunCalcLazyDay( double J, double lw, double sinphi, double cosphi, const double * altitudes ) : lw(lw), computed(0) {
+        using namespace ofxSunCalcCore;
+        n = getJulianCycle(J, lw);
+        double Js = getApproxSolarTransit(0, lw, n);
+        double M = getSolarMeanAnomaly(Js);
+        double C = getEquationOfCenter(M);
+        double Lsun = getEclipticLongitude(M, C);
+        double d = getSunDeclination(Lsun);
+        Jtransit = getSolarTransit(Js, M, Lsun);
+        geometry = getDayGeometry(sinphi, cosphi, d);
+        a = J1 * std::sin(M);
+        b = J2 * std::sin(2 * Lsun);
+        for(int k = 0; k < numAltitudes; k++) {
+            sinAlt[k] = altitudes[k];
+        }
+    }
+
+    double setting( Altitude i ) {
+        if(!(computed & (1u << i))) {
+            double w = ofxSunCalcCore::getHourAngle(geometry, sinAlt[i]);
+            sets[i] = std::isnan(w) ? NAN : ofxSunCalcCore::getApproxSolarTransit(w, lw, n) + a + b;
+            computed |= 1u << i;
+        }
+        return sets[i];
+    }
+
+    double rising( Altitude i ) {
+        return ofxSunCalcCore::getSunriseJulianDate(Jtransit, setting(i));
+    }
+
+    double lw;
+    double n;
+    double Jtransit;
+    double a, b; // transit terms of getSunsetJulianDate
+    ofxSunCalcCore::DayGeometry geometry;
+    double sinAlt[numAltitudes];
+
+    double sets[numAltitudes];
+    uint32_t computed;
+
+};
+
+#endif /* defined(__ofxSunCalcLazyDay__) */
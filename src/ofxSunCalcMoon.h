@@ -0,0 +1,208 @@
+//
+//  ofxSunCalcMoon.h
+//
+//  Moon illumination and moon rise / set / transit (see getMoonIllumination / getMoonTimes
+//  in suncalc.js).
+//
+//  Rise / set are the roots of the (refraction corrected) moon altitude minus 0.133 degrees,
+//  transit the upward zero crossing of the moon's hour angle. The day is sampled every
+//  moonSampleHours to bracket sign changes, each bracket is then refined by Illinois
+//  (regula falsi) iteration to about a second, typically 4-6 more evaluations. Roots closer
+//  together than the sample step (grazing the horizon) can be missed.
+//
+//  Header only, no openFrameworks / Poco dependency.
+//
+
+#ifndef __ofxSunCalcMoon__
+#define __ofxSunCalcMoon__
+
+#include "ofxSunCalcCore.h"
+
+typedef struct {
+    double fraction;    // illuminated fraction, 0 new moon -> 1 full moon
+    double phase;       // 0 new moon, 0.25 first quarter, 0.5 full moon, 0.75 last quarter
+    double angle;       // midpoint angle of the illuminated limb, radians
+} MoonCalcIllumination;
+
+// Julian dates, NaN when the event does not happen within the day.
+typedef struct {
+    double rise;
+    double set;
+    double transit;
+    bool alwaysUp;      // above the horizon all day
+    bool alwaysDown;    // below the horizon all day
+} MoonCalcDayTimes;
+
+namespace ofxSunCalcCore {
+
+    constexpr double moonRiseAngle = 0.133 * deg2rad;
+    constexpr int moonSampleHours = 2;
+    constexpr double moonRootTolerance = 1.0 / 86400; // days
+
+    inline MoonCalcIllumination getMoonIllumination( double J ) noexcept {
+        double d = J - J2000;
+
+        double M = getSolarMeanAnomaly(J);
+        double Lsun = getEclipticLongitude(M, getEquationOfCenter(M));
+        double sdec = getSunDeclination(Lsun);
+        double sra = getRightAscension(Lsun);
+
+        double mra, mdec, mdist;
+        getMoonCoords(d, mra, mdec, mdist);
+
+        const double sdist = 149598000; // distance from Earth to Sun in km
+
+        double phi = std::acos(std::sin(sdec) * std::sin(mdec) + std::cos(sdec) * std::cos(mdec) * std::cos(sra - mra));
+        double inc = std::atan2(sdist * std::sin(phi), mdist - sdist * std::cos(phi));
+        double angle = std::atan2(std::cos(sdec) * std::sin(sra - mra), std::sin(sdec) * std::cos(mdec) - std::cos(sdec) * std::sin(mdec) * std::cos(sra - mra));
+
+        MoonCalcIllumination ill;
+        ill.fraction = (1 + std::cos(inc)) / 2;
+        ill.phase = 0.5 + 0.5 * inc * (angle < 0 ? -1 : 1) / pi;
+        ill.angle = angle;
+        return ill;
+    }
+
+    // Moon altitude above the rise / set angle and hour angle (wrapped to [-pi, pi]) at J.
+    typedef struct {
+        double height;
+        double hourAngle;
+    } MoonHorizonSample;
+
+    inline MoonHorizonSample getMoonHorizonSample( double J, double lw, double phi ) noexcept {
+        double d = J - J2000;
+        double ra, dec, dist;
+        getMoonCoords(d, ra, dec, dist);
+
+        double H = siderealTime(d, lw) - ra;
+        double h = altitude(H, phi, dec);
+
+        MoonHorizonSample s;
+        s.height = h + astroRefraction(h) - moonRiseAngle;
+        s.hourAngle = std::remainder(H, 2 * pi);
+        return s;
+    }
+
+    // As seen by observer: its refraction scale, and the rise / set angle lowered by the dip of
+    // its horizon, as its sun events are.
+    inline MoonHorizonSample getMoonHorizonSample( double J, const SunCalcObserver & o ) noexcept {
+        double d = J - J2000;
+        double ra, dec, dist;
+        getMoonCoords(d, ra, dec, dist);
+
+        double H = siderealTime(d, o.lw) - ra;
+        double h = std::asin(o.sinPhi * std::sin(dec) + o.cosPhi * std::cos(dec) * std::cos(H));
+
+        MoonHorizonSample s;
+        s.height = h + o.refraction * astroRefraction(h) - (moonRiseAngle + getHorizonDip(o.elevation));
+        s.hourAngle = std::remainder(H, 2 * pi);
+        return s;
+    }
+
+    // Illinois root refinement of f on [a, b] where fa, fb have opposite signs.
+    template<typename F>
+    double refineMoonRoot( F f, double a, double fa, double b, double fb ) noexcept {
+        for(int i = 0; i < 30 && std::fabs(b - a) > moonRootTolerance; i++) {
+            double c = (a * fb - b * fa) / (fb - fa);
+            double fc = f(c);
+            if(fc == 0) return c;
+            if((fc < 0) != (fb < 0)) {
+                a = b;
+                fa = fb;
+            }else{
+                fa *= 0.5;
+            }
+            b = c;
+            fb = fc;
+        }
+        return b;
+    }
+
+    // Fills one day starting at J0 from samples[0..samplesPerDay] (moonSampleHours apart),
+    // sample( J ) is the MoonHorizonSample the roots are refined with.
+    template<typename F>
+    MoonCalcDayTimes getMoonTimesFromSamples( double J0, F sample, const MoonHorizonSample * samples ) noexcept {
+        const int steps = 24 / moonSampleHours;
+        const double dt = moonSampleHours / 24.0;
+
+        auto height = [&](double J) { return sample(J).height; };
+        auto hourAngle = [&](double J) { return sample(J).hourAngle; };
+
+        MoonCalcDayTimes t;
+        t.rise = t.set = t.transit = NAN;
+
+        for(int i = 0; i < steps; i++) {
+            const MoonHorizonSample & a = samples[i];
+            const MoonHorizonSample & b = samples[i + 1];
+            double Ja = J0 + i * dt;
+            double Jb = Ja + dt;
+
+            if(std::isnan(t.rise) && a.height < 0 && b.height >= 0) {
+                t.rise = refineMoonRoot(height, Ja, a.height, Jb, b.height);
+            }
+            if(std::isnan(t.set) && a.height >= 0 && b.height < 0) {
+                t.set = refineMoonRoot(height, Ja, a.height, Jb, b.height);
+            }
+            // upward crossing of 0, not the wrap from pi to -pi
+            if(std::isnan(t.transit) && a.hourAngle < 0 && b.hourAngle >= 0 && b.hourAngle - a.hourAngle < pi) {
+                t.transit = refineMoonRoot(hourAngle, Ja, a.hourAngle, Jb, b.hourAngle);
+            }
+        }
+
+        bool up = samples[0].height >= 0;
+        t.alwaysUp = std::isnan(t.rise) && std::isnan(t.set) && up;
+        t.alwaysDown = std::isnan(t.rise) && std::isnan(t.set) && !up;
+        return t;
+    }
+
+    inline MoonCalcDayTimes getMoonTimesFromSamples( double J0, double lw, double phi, const MoonHorizonSample * samples ) noexcept {
+        return getMoonTimesFromSamples(J0, [&](double J) { return getMoonHorizonSample(J, lw, phi); }, samples);
+    }
+
+    // numDays consecutive days from J0 with the sampler sample( J ), sharing the samples at day
+    // boundaries between neighbouring days.
+    template<typename F>
+    void getMoonTimesSampled( double J0, int numDays, F sample, MoonCalcDayTimes * out ) noexcept {
+        const int steps = 24 / moonSampleHours;
+        MoonHorizonSample samples[24 / moonSampleHours + 1];
+        if(numDays <= 0) return;
+        samples[0] = sample(J0);
+        for(int day = 0; day < numDays; day++) {
+            double Jd = J0 + day;
+            for(int i = 1; i <= steps; i++) {
+                samples[i] = sample(Jd + i * moonSampleHours / 24.0);
+            }
+            out[day] = getMoonTimesFromSamples(Jd, sample, samples);
+            samples[0] = samples[steps];
+        }
+    }
+
+    // Moon rise / set / transit within [J0, J0 + 1)
+    inline MoonCalcDayTimes getMoonTimes( double J0, double lw, double phi ) noexcept {
+        MoonCalcDayTimes t;
+        getMoonTimesSampled(J0, 1, [&](double J) { return getMoonHorizonSample(J, lw, phi); }, &t);
+        return t;
+    }
+
+    // Multi day moon table, out[day] for [J0 + day, J0 + day + 1). Samples at day boundaries
+    // are shared between neighbouring days.
+    inline void getMoonTimes( double J0, int numDays, double lw, double phi, MoonCalcDayTimes * out ) noexcept {
+        getMoonTimesSampled(J0, numDays, [&](double J) { return getMoonHorizonSample(J, lw, phi); }, out);
+    }
+
+    // For a fixed observer (ofxSunCalcCore::getObserver): no latitude trig per sample, and
+    // rise / set follow its elevation and refraction. A default observer matches the lw / phi
+    // forms to rounding.
+    inline MoonCalcDayTimes getMoonTimes( double J0, const SunCalcObserver & o ) noexcept {
+        MoonCalcDayTimes t;
+        getMoonTimesSampled(J0, 1, [&](double J) { return getMoonHorizonSample(J, o); }, &t);
+        return t;
+    }
+
+    inline void getMoonTimes( double J0, int numDays, const SunCalcObserver & o, MoonCalcDayTimes * out ) noexcept {
+        getMoonTimesSampled(J0, numDays, [&](double J) { return getMoonHorizonSample(J, o); }, out);
+    }
+
+}
+
+#endif /* defined(__ofxSunCalcMoon__) */
@@ -0,0 +1,134 @@
+//
+//  ofxSunCalcPrecision.h
+//
+//  Sun / moon positions with the working precision as a template parameter (float or double),
+//  for float vertex buffers and narrower SIMD / ARM targets.
+//
+//  Julian dates stay double: a float can't resolve the time of day near J ~ 2.45e6, and the
+//  sidereal angle grows by ~2 pi per day. The time dependent angles (mean anomalies, sidereal
+//  time) are reduced to [-pi, pi] in double first, everything after that (equation of center,
+//  ecliptic -> equatorial -> horizontal) runs in T. For the same reason day times (Julian
+//  dates) are not templated.
+//
+//  Max deviation of the float path from the double path over latitudes -89..89 and
+//  1900..2100 (checked by tests/precision.cpp, `make test` in tests/ fails past them):
+//
+//      |true altitude|     altitude    azimuth     (radians, sun and moon alike)
+//      < 80 degrees        2e-6        5e-6
+//      < 89.9 degrees      5e-5        2e-4
+//      any                 1e-4        1e-3        asin / atan2 are ill conditioned at the zenith
+//
+//  Moon distance is within 0.05 km.
+//
+//  T = double matches ofxSunCalcCore::getSunPosition / getMoonPosition to < 1e-8 (rounding only).
+//
+//  Header only, no openFrameworks / Poco dependency.
+//
+
+#ifndef __ofxSunCalcPrecision__
+#define __ofxSunCalcPrecision__
+
+#include <cstddef>
+
+#include "ofxSunCalcCore.h"
+
+template<typename T>
+struct SunCalcPositionT {
+    T azimuth;
+    T altitude;
+};
+
+template<typename T>
+struct MoonCalcPositionT {
+    T azimuth;
+    T altitude;
+    T distance;
+    T parallacticAngle;
+};
+
+typedef SunCalcPositionT<float> SunCalcPositionF;
+typedef MoonCalcPositionT<float> MoonCalcPositionF;
+
+namespace ofxSunCalcCore {
+
+    // a to [-pi, pi] in double, then narrowed
+    template<typename T>
+    inline T reduceAngle( double a ) noexcept {
+        return (T)std::remainder(a, 2 * pi);
+    }
+
+    // Time only part of the sun model at J: declination and the hour angle at lw = 0.
+    template<typename T>
+    inline void getSunEquatorialT( double J, T & dec, T & H ) noexcept {
+        T M = reduceAngle<T>(getSolarMeanAnomaly(J));
+        T C = (T)C1 * std::sin(M) + (T)C2 * std::sin(2 * M) + (T)C3 * std::sin(3 * M);
+        T L = M + (T)(P + pi) + C;
+        T sinL = std::sin(L);
+        dec = std::asin(sinL * (T)std::sin(e));
+        T ra = std::atan2(sinL * (T)std::cos(e), std::cos(L));
+        H = reduceAngle<T>(getSiderealTime(J, 0)) - ra;
+    }
+
+    template<typename T>
+    inline SunCalcPositionT<T> getSunPositionT( double J, T lw, T phi ) noexcept {
+        T dec, Ha;
+        getSunEquatorialT<T>(J, dec, Ha);
+        T H = Ha - lw;
+
+        SunCalcPositionT<T> pos;
+        pos.azimuth = std::atan2(std::sin(H), std::cos(H) * std::sin(phi) - std::tan(dec) * std::cos(phi));
+        pos.altitude = std::asin(std::sin(phi) * std::sin(dec) + std::cos(phi) * std::cos(dec) * std::cos(H));
+        return pos;
+    }
+
+    // Many sites at one instant, the time part is evaluated once.
+    template<typename T>
+    inline void getSunPositionsT( double J, const T * lw, const T * phi, size_t count, T * azimuth, T * altitude ) noexcept {
+        T dec, Ha;
+        getSunEquatorialT<T>(J, dec, Ha);
+        T sind = std::sin(dec), cosd = std::cos(dec), tand = std::tan(dec);
+        for(size_t i = 0; i < count; i++) {
+            T H = Ha - lw[i];
+            T sinphi = std::sin(phi[i]);
+            T cosphi = std::cos(phi[i]);
+            T cosH = std::cos(H);
+            azimuth[i] = std::atan2(std::sin(H), cosH * sinphi - tand * cosphi);
+            altitude[i] = std::asin(sinphi * sind + cosphi * cosd * cosH);
+        }
+    }
+
+    template<typename T>
+    inline MoonCalcPositionT<T> getMoonPositionT( double J, T lw, T phi ) noexcept {
+        double d = J - J2000;
+        T L = reduceAngle<T>(deg2rad * (218.316 + 13.176396 * d));
+        T M = reduceAngle<T>(deg2rad * (134.963 + 13.064993 * d));
+        T F = reduceAngle<T>(deg2rad * (93.272 + 13.229350 * d));
+
+        T l = L + (T)(deg2rad * 6.289) * std::sin(M);
+        T b = (T)(deg2rad * 5.128) * std::sin(F);
+        T dist = (T)385001 - (T)20905 * std::cos(M);
+
+        T sine = (T)std::sin(e), cose = (T)std::cos(e);
+        T ra = std::atan2(std::sin(l) * cose - std::tan(b) * sine, std::cos(l));
+        T dec = std::asin(std::sin(b) * cose + std::cos(b) * sine * std::sin(l));
+
+        T H = reduceAngle<T>(siderealTime(d, 0)) - lw - ra;
+        T sinphi = std::sin(phi), cosphi = std::cos(phi);
+        T sinH = std::sin(H), cosH = std::cos(H);
+        T h = std::asin(sinphi * std::sin(dec) + cosphi * std::cos(dec) * cosH);
+
+        // refraction as astroRefraction
+        T hr = h < 0 ? (T)0 : h;
+        T refraction = (T)0.0002967 / std::tan(hr + (T)0.00312536 / (hr + (T)0.08901179));
+
+        MoonCalcPositionT<T> mp;
+        mp.azimuth = std::atan2(sinH, cosH * sinphi - std::tan(dec) * cosphi);
+        mp.altitude = h + refraction;
+        mp.distance = dist;
+        mp.parallacticAngle = std::atan2(sinH, std::tan(phi) * std::cos(dec) - std::sin(dec) * cosH);
+        return mp;
+    }
+
+}
+
+#endif /* defined(__ofxSunCalcPrecision__) */
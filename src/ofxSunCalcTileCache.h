@@ -0,0 +1,89 @@
+//
+//  ofxSunCalcTileCache.h
+//
+//  Day times for arbitrary coordinates on one day, answered by bilinear interpolation between
+//  exact solutions at the corners of lat / lon tiles (0.25 degrees by default) that are built
+//  lazily as queries arrive. Every event time is interpolated relative to the corners.
+//
+//  When a tile is built its interpolation is checked against exact solutions at the tile centre
+//  and edge midpoints. Tiles that miss maxErrorSeconds there, or whose corners disagree on which
+//  events happen (near the polar circles) or on the solar day, are split into quarters, down to
+//  maxDepth levels; below that their queries are computed directly. maxErrorSeconds is a
+//  sampled bound: it holds at the probe points, elsewhere in a tile the error follows the
+//  smooth (second order) bilinear error and stays near it in practice, but it is not guaranteed.
+//
+//  Queries are thread safe, tiles live until clear() (which must not run concurrently with them).
+//
+
+#ifndef __ofxSunCalcTileCache__
+#define __ofxSunCalcTileCache__
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+
+#include "ofxSunCalcCore.h"
+
+class ofxSunCalcTileCache {
+
+public:
+
+    // J picks the day as for ofxSunCalcCore::getDayTimes( J, ... ). tileDegrees outside
+    // (0, 360] falls back to 0.25; tiles are kept above ~3e-6 degrees, and maxDepth is lowered
+    // so the deepest level still fits the tile keys.
+    ofxSunCalcTileCache( double J, bool detailed = false, double tileDegrees = 0.25, double maxErrorSeconds = 1.0, int maxDepth = 5 );
+
+    // lat / lon in degrees. A lat outside -90..90 or a NaN / infinite coordinate is not on
+    // the grid, it is passed to ofxSunCalcCore::getDayTimes as is.
+    SunCalcDayTimes getDayTimes( double lat, double lon );
+    SunCalcDayTimes getDayTimes( const SunCalcSite & site ) { return getDayTimes(site.lat, site.lon); }
+
+    // Not while other threads are querying.
+    void clear();
+
+    double getJulianDate() const { return J; }
+    size_t getNumTiles() const;
+    size_t getInterpolatedCount() const { return interpolated.load(); }
+    size_t getDirectCount() const { return direct.load(); }
+
+private:
+
+    enum TileState { TILE_LEAF, TILE_SPLIT, TILE_DIRECT };
+
+    typedef struct {
+        TileState state;
+        SunCalcDayTimes corners[4]; // (lat0, lon0), (lat0, lon1), (lat1, lon0), (lat1, lon1), leaves only
+    } Tile;
+
+    SunCalcDayTimes exact( double lat, double lon ) const;
+    Tile buildTile( int depth, int64_t iy, int64_t ix ) const;
+    bool withinBound( const SunCalcDayTimes & approx, const SunCalcDayTimes & exact ) const;
+
+    static SunCalcDayTimes interpolate( const SunCalcDayTimes * corners, double ty, double tx );
+    static uint64_t tileKey( int depth, int64_t iy, int64_t ix );
+
+    // tile grid per subdivision depth
+    typedef struct {
+        double size;    // degrees
+        double scale;   // 1 / size
+        int64_t rows;
+        int64_t columns;
+    } Level;
+
+    double J;
+    bool detailed;
+    double tileDegrees;
+    double maxErrorDays;
+    int maxDepth;
+    Level levels[16];
+
+    mutable std::mutex mutex;
+    std::unordered_map<uint64_t, Tile> tiles;
+
+    std::atomic<size_t> interpolated;
+    std::atomic<size_t> direct;
+
+};
+
+#endif /* defined(__ofxSunCalcTileCache__) */
@@ -0,0 +1,134 @@
+#include "ofxSunCalcTimeline.h"
+
+#include "ofxSunCalcSweep.h"
+
+#include <algorithm>
+
+using namespace ofxSunCalcCore;
+
+ofxSunCalcTimeline::Palette ofxSunCalcTimeline::getDefaultPalette() {
+    Palette palette;
+    palette.bands[BAND_NIGHT] = ofColor(127, 142, 180);
+    palette.bands[BAND_ASTRONOMICAL] = ofColor(145, 165, 200);
+    palette.bands[BAND_NAUTICAL] = ofColor(162, 189, 220);
+    palette.bands[BAND_CIVIL] = ofColor(180, 212, 239);
+    palette.bands[BAND_SUNRISE_SUNSET] = ofColor(254, 237, 127);
+    palette.bands[BAND_DAY] = ofColor(254, 215, 127);
+    palette.curve = ofColor(200, 60, 40);
+    palette.markers = ofColor(255, 255, 255, 96);
+    return palette;
+}
+
+ofxSunCalcTimeline::Band ofxSunCalcTimeline::getBand( double altitude ) {
+    if(altitude >= h0 + d0) return BAND_DAY;
+    if(altitude >= h0) return BAND_SUNRISE_SUNSET;
+    if(altitude >= h1) return BAND_CIVIL;
+    if(altitude >= h2) return BAND_NAUTICAL;
+    if(altitude >= h3) return BAND_ASTRONOMICAL;
+    return BAND_NIGHT;
+}
+
+void ofxSunCalcTimeline::addDayBands( ofMesh & mesh, const SunCalcSite & site, double dayStartJ, const ofRectangle & rect, const Palette & palette ) {
+    double lw = -site.lon * deg2rad;
+    double phi = site.lat * deg2rad;
+
+    // edges as fractions of the day, from the three solar days that can overlap it
+    const int edgesPerDay = 10;
+    double edges[3 * edgesPerDay + 2];
+    int numEdges = 0;
+    edges[numEdges++] = 0;
+    for(int k = -1; k <= 1; k++) {
+        SunCalcDayTimes times = getDayTimes(dayStartJ + 0.5 + k, lw, phi, true);
+        // every event but transit, which isn't an edge
+        const double t[edgesPerDay] = {
+            times.nightEnd, times.nauticalDawn, times.dawn, times.sunriseStart, times.sunriseEnd,
+            times.sunsetStart, times.sunsetEnd, times.dusk, times.nauticalDusk, times.nightStart
+        };
+        for(int i = 0; i < edgesPerDay; i++) {
+            double f = t[i] - dayStartJ;
+            if(f > 0 && f < 1) edges[numEdges++] = f;
+        }
+    }
+    edges[numEdges++] = 1;
+    std::sort(edges + 1, edges + numEdges - 1);
+
+    float y0 = rect.getMinY();
+    float y1 = rect.getMaxY();
+    double start = 0;
+    Band band = getBand(getSunPosition(dayStartJ + 0.5 * edges[1], lw, phi).altitude);
+    for(int i = 1; i < numEdges; i++) {
+        Band next = i + 1 < numEdges ? getBand(getSunPosition(dayStartJ + 0.5 * (edges[i] + edges[i + 1]), lw, phi).altitude) : band;
+        // merge runs of the same band, so an edge that doesn't change the band costs nothing
+        if(next != band || i + 1 == numEdges) {
+            float x0 = rect.x + start * rect.width;
+            float x1 = rect.x + edges[i] * rect.width;
+            addQuad(mesh, ofVec3f(x0, y0), ofVec3f(x1, y0), ofVec3f(x1, y1), ofVec3f(x0, y1), palette.bands[band]);
+            start = edges[i];
+            band = next;
+        }
+    }
+}
+
+void ofxSunCalcTimeline::addAltitudeCurve( ofMesh & mesh, const SunCalcSite & site, double dayStartJ, const ofRectangle & rect, const ofColor & color, int samples, float thickness ) {
+    if(samples < 1) return;
+    std::vector<SunCalcPosition> positions(samples + 1);
+    sweepSunPositions(site, dayStartJ, 86400.0 / samples, positions.size(), positions.data());
+
+    float half = thickness * 0.5f;
+    float midY = rect.getCenter().y;
+    float scale = rect.height / pi;
+    ofVec3f prev(rect.x, midY - positions[0].altitude * scale);
+    for(int i = 1; i <= samples; i++) {
+        ofVec3f p(rect.x + rect.width * i / samples, midY - positions[i].altitude * scale);
+        ofVec3f d = p - prev;
+        float len = d.length();
+        ofVec3f n = len > 0 ? ofVec3f(-d.y, d.x) * (half / len) : ofVec3f(0, half);
+        addQuad(mesh, prev + n, p + n, p - n, prev - n, color);
+        prev = p;
+    }
+}
+
+void ofxSunCalcTimeline::addHourMarkers( ofMesh & mesh, const ofRectangle & rect, const ofColor & color, int hourStep ) {
+    if(hourStep < 1) return;
+    float y0 = rect.getMinY();
+    float y1 = rect.getMaxY();
+    for(int hr = 0; hr < 24; hr += hourStep) {
+        float x = rect.x + rect.width * hr / 24;
+        addQuad(mesh, ofVec3f(x, y0), ofVec3f(x + 1, y0), ofVec3f(x + 1, y1), ofVec3f(x, y1), color);
+    }
+}
+
+ofMesh ofxSunCalcTimeline::buildDay( const SunCalcSite & site, double dayStartJ, const ofRectangle & rect, bool withCurve, const Palette & palette ) {
+    ofMesh mesh;
+    mesh.setMode(OF_PRIMITIVE_TRIANGLES);
+    addDayBands(mesh, site, dayStartJ, rect, palette);
+    if(withCurve) addAltitudeCurve(mesh, site, dayStartJ, rect, palette.curve);
+    return mesh;
+}
+
+ofMesh ofxSunCalcTimeline::buildHeatmap( const SunCalcSite & site, double firstDayJ, int numDays, const ofRectangle & rect, const Palette & palette ) {
+    ofMesh mesh;
+    mesh.setMode(OF_PRIMITIVE_TRIANGLES);
+    if(numDays < 1) return mesh;
+    float rowH = rect.height / numDays;
+    for(int day = 0; day < numDays; day++) {
+        addDayBands(mesh, site, firstDayJ + day, ofRectangle(rect.x, rect.y + day * rowH, rect.width, rowH), palette);
+    }
+    return mesh;
+}
+
+void ofxSunCalcTimeline::addQuad( ofMesh & mesh, const ofVec3f & a, const ofVec3f & b, const ofVec3f & c, const ofVec3f & d, const ofColor & color ) {
+    ofIndexType base = mesh.getNumVertices();
+    mesh.addVertex(a);
+    mesh.addVertex(b);
+    mesh.addVertex(c);
+    mesh.addVertex(d);
+    ofFloatColor fc(color);
+    for(int i = 0; i < 4; i++) mesh.addColor(fc);
+    mesh.addIndex(base);
+    mesh.addIndex(base + 1);
+    mesh.addIndex(base + 2);
+    mesh.addIndex(base);
+    mesh.addIndex(base + 2);
+    mesh.addIndex(base + 3);
+}
@@ -0,0 +1,72 @@
+//
+//  ofxSunCalcTimeline.h
+//
+//  Retained mode day timelines: the light bands of a day (night, astronomical / nautical / civil
+//  twilight, sunrise / sunset, day), an optional sun altitude curve and hour markers, built as
+//  coloured triangles into an ofMesh once and then drawn with a single call. All the add*
+//  functions append, so any number of days can be batched into one mesh, which is what
+//  buildHeatmap does for a year at a glance (one row per day).
+//
+//  Days run 00:00 - 24:00 from dayStartJ (a Julian date, eg. floor(J - 0.5) + 0.5 for the UTC
+//  day, minus the utc offset in days for local time) across the rect. Band edges come from the
+//  day times of the solar days overlapping it, each band is coloured by the sun altitude at its
+//  middle, so polar days / nights and days without some twilights need no special casing.
+//  On days where the sun barely reaches a twilight altitude the band can differ from
+//  getSunPosition by some minutes (the day times and position models differ by arc minutes).
+//
+
+#ifndef __ofxSunCalcTimeline__
+#define __ofxSunCalcTimeline__
+
+#include "ofMain.h"
+
+#include "ofxSunCalcCore.h"
+
+class ofxSunCalcTimeline {
+
+public:
+
+    enum Band {
+        BAND_NIGHT,
+        BAND_ASTRONOMICAL,      // sun -18 .. -12 degrees
+        BAND_NAUTICAL,          // -12 .. -6
+        BAND_CIVIL,             // -6 .. -0.833
+        BAND_SUNRISE_SUNSET,    // sun disk crossing the horizon, -0.833 .. -0.3
+        BAND_DAY,
+        numBands
+    };
+
+    typedef struct {
+        ofColor bands[numBands];
+        ofColor curve;
+        ofColor markers;
+    } Palette;
+
+    // Colours of drawSimpleDayInfoTimeline, with the twilights shaded between night and civil.
+    static Palette getDefaultPalette();
+
+    static Band getBand( double altitude );
+
+    // Appends the bands of one day as quads (OF_PRIMITIVE_TRIANGLES).
+    static void addDayBands( ofMesh & mesh, const SunCalcSite & site, double dayStartJ, const ofRectangle & rect, const Palette & palette );
+
+    // Appends the sun altitude over the day as a thickness pixel wide line of quads, -90 degrees
+    // at the bottom of rect to 90 at the top, from samples + 1 points.
+    static void addAltitudeCurve( ofMesh & mesh, const SunCalcSite & site, double dayStartJ, const ofRectangle & rect, const ofColor & color, int samples = 96, float thickness = 1.5 );
+
+    // Appends 1 pixel vertical lines every hourStep hours, 00:00 included.
+    static void addHourMarkers( ofMesh & mesh, const ofRectangle & rect, const ofColor & color, int hourStep = 1 );
+
+    // One day: bands, plus the altitude curve when withCurve.
+    static ofMesh buildDay( const SunCalcSite & site, double dayStartJ, const ofRectangle & rect, bool withCurve = false, const Palette & palette = getDefaultPalette() );
+
+    // numDays consecutive days from firstDayJ, one row each from the top of rect down.
+    static ofMesh buildHeatmap( const SunCalcSite & site, double firstDayJ, int numDays, const ofRectangle & rect, const Palette & palette = getDefaultPalette() );
+
+private:
+
+    static void addQuad( ofMesh & mesh, const ofVec3f & a, const ofVec3f & b, const ofVec3f & c, const ofVec3f & d, const ofColor & color );
+
+};
+
+#endif /* defined(__ofxSunCalcTimeline__) */
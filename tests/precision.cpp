@@ -0,0 +1,80 @@
+//
+//  precision.cpp
+//
+//  Checks the float error bounds documented in ofxSunCalcPrecision.h: the float path against
+//  the double path over latitudes -89..89 and 1900..2100. Prints the max errors and exits
+//  nonzero if a bound is exceeded. Only needs the header only core, see tests/Makefile.
+//
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+#include "ofxSunCalcPrecision.h"
+
+namespace {
+
+    const char * limitNames[3] = { "< 80", "< 89.9", "any" };
+    const double limits[3] = { 80, 89.9, 180 };                                     // |true altitude|, degrees
+    const double bounds[3][2] = { { 2e-6, 5e-6 }, { 5e-5, 2e-4 }, { 1e-4, 1e-3 } }; // altitude, azimuth
+    const double distanceBound = 0.05;                                              // km
+
+    // Max errors of one body, returns false if one is above its bound.
+    bool check( const char * name, bool moon ) {
+        using namespace ofxSunCalcCore;
+
+        double err[3][2] = { { 0, 0 }, { 0, 0 }, { 0, 0 } };
+        double distanceErr = 0;
+        size_t samples = 0;
+
+        for(double J = 2415020.0; J < 2488070; J += 3.137) {
+            for(double lat = -89; lat <= 89; lat += 7.7) {
+                double lon = std::remainder(J * 13.7, 360.0);
+                float lw = -lon * deg2rad;
+                float phi = lat * deg2rad;
+                double alt, az, altF, azF;
+                if(moon) {
+                    MoonCalcPosition p = getMoonPosition(J, lw, phi);
+                    MoonCalcPositionF f = getMoonPositionT<float>(J, lw, phi);
+                    alt = p.altitude; az = p.azimuth; altF = f.altitude; azF = f.azimuth;
+                    distanceErr = std::max(distanceErr, std::fabs(f.distance - p.distance));
+                }else{
+                    SunCalcPosition p = getSunPosition(J, lw, phi);
+                    SunCalcPositionF f = getSunPositionT<float>(J, lw, phi);
+                    alt = p.altitude; az = p.azimuth; altF = f.altitude; azF = f.azimuth;
+                }
+                double ea = std::fabs(altF - alt);
+                double ez = std::fabs(std::remainder(azF - az, 2 * pi));
+                for(int k = 0; k < 3; k++) {
+                    if(std::fabs(alt) < limits[k] * deg2rad) {
+                        err[k][0] = std::max(err[k][0], ea);
+                        err[k][1] = std::max(err[k][1], ez);
+                    }
+                }
+                samples++;
+            }
+        }
+
+        bool ok = true;
+        printf("%s, %zu samples\n", name, samples);
+        for(int k = 0; k < 3; k++) {
+            bool pass = err[k][0] <= bounds[k][0] && err[k][1] <= bounds[k][1];
+            printf("    %-8s altitude %.3g (%.0e)  azimuth %.3g (%.0e)  %s\n", limitNames[k],
+                   err[k][0], bounds[k][0], err[k][1], bounds[k][1], pass ? "ok" : "FAILED");
+            ok = ok && pass;
+        }
+        if(moon) {
+            bool pass = distanceErr <= distanceBound;
+            printf("    distance %.3g km (%.2g)  %s\n", distanceErr, distanceBound, pass ? "ok" : "FAILED");
+            ok = ok && pass;
+        }
+        return ok;
+    }
+
+}
+
+int main() {
+    bool ok = check("sun", false);
+    ok = check("moon", true) && ok;
+    return ok ? 0 : 1;
+}